@@ -3,6 +3,10 @@
 #define A1B8_H
 
 #include <string>
-void convertNDFSMtoDFSM(const std::string& inputNDFSMFile, const std::string& outputDFSMFile);
+#include "NDFSMtoDFSM.h"
+
+inline void convertNDFSMtoDFSM(const std::string& inputNDFSMFile, const std::string& outputDFSMFile) {
+    NDFSMtoDFSM::convert(inputNDFSMFile, outputDFSMFile);
+}
 
 #endif
@@ -1,29 +1,96 @@
+// A2B Program
+// Builds the pattern-recognizing NDFSM, converts it to a minimal DFSM and
+// tests an input string with it. Compiled DFSMs are kept in an on-disk cache
+// keyed by the pattern, so a pattern is only built and converted once.
+//
+// HOW TO RUN THE CODE:
+// >>g++ -std=c++17 -O2 -o A2B A2B.cpp
+// >>./A2B [--cache <directory>] [--stats] <pattern_to_recognize> [<input string file>]
+
 #include <iostream>
 #include <string>
 
-// Assuming the necessary includes for NDFSMBuilder, NDFSMtoDFSM, and DFSM classes or functions are available
-#include "A1B4.cpp"
-#include "A1B8.cpp"
-#include "A1A.cpp"
+#include "NDFSMBuilder.h"
+#include "NDFSMtoDFSM.h"
+#include "FSMCache.h"
+#include "MappedFile.h"
+#include "Stats.h"
 
 int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <pattern_to_recognize>\n";
+    bool wantStats = Stats::takeFlag(argc, argv);
+    Stats stats("A2B");
+    Stats* statsOut = wantStats ? &stats : nullptr;
+    std::string cacheDirectory = ".fsmcache";
+    int arg = 1;
+    if (argc > 2 && std::string(argv[1]) == "--cache") {
+        cacheDirectory = argv[2];
+        arg = 3;
+    }
+    if (argc - arg != 1 && argc - arg != 2) {
+        std::cerr << "Usage: " << argv[0] << " [--cache <directory>] [--stats] <pattern_to_recognize> [<input string file>]\n";
         return 1;
     }
 
-    std::string pattern = argv[1];
-
-    // Step 1: Build NDFSM using the NDFSMBuilder
+    std::string pattern = argv[arg];
+    std::string inputFile = argc - arg == 2 ? argv[arg + 1] : "INPUT.txt";
     std::string ndfsmFile = "NDFSM.txt";
-    NDFSMBuilder::buildNDFSM(pattern, ndfsmFile);  // Implement this method in NDFSMBuilder.cpp
-
-    // Step 2: Convert NDFSM to DFSM
     std::string dfsmFile = "DFSM.txt";
-    NDFSMtoDFSM::convert(ndfsmFile, dfsmFile);  // Implement this method in NDFSMtoDFSM.cpp
 
-    // Step 3: Test DFSM
-    DFSM::testDFSM(dfsmFile);  // Implement this function in DFSM.cpp to test the DFSM
+    try {
+        FSMCache cache(cacheDirectory);
+        std::string key = FSMCache::keyFor("NDFSMBuilder", pattern, "minimized");
+        DFSM dfsm;
+        Stats::Stage lookup(statsOut, "cache_lookup");
+        bool hit = cache.load(key, dfsm);
+        lookup.stop();
+        stats.set("cache_hit", hit);
+        if (hit) {
+            std::cout << "DFSM for the pattern loaded from cache " << cacheDirectory << std::endl;
+        } else {
+            // Step 1: Build NDFSM using the NDFSMBuilder
+            Stats::Stage build(statsOut, "build_ndfsm");
+            build.addBytes(pattern.size());
+            if (!NDFSMBuilder::buildNDFSM(ndfsmFile, pattern)) {
+                // NDFSM.txt may be left from another pattern; nothing is cached
+                throw std::runtime_error("Could not build the NDFSM for the pattern");
+            }
+            build.stop();
+            NDFSM ndfsm;
+            Stats::Stage read(statsOut, "read_ndfsm");
+            read.addBytes(Stats::fileBytes(ndfsmFile));
+            ndfsm.readFromFile(ndfsmFile);
+            read.stop();
 
+            // Step 2: Convert NDFSM to a minimal DFSM
+            dfsm = NDFSMtoDFSM::convertToDFSM(ndfsm, 1, true, statsOut);
+            Stats::Stage store(statsOut, "cache_store");
+            cache.store(key, dfsm);
+        }
+        Stats::Stage write(statsOut, "write_dfsm");
+        dfsm.writeToFile(dfsmFile);
+        write.stop();
+
+        // Step 3: Test DFSM on the input string
+        MappedFile input(inputFile);
+        Stats::Stage simulate(statsOut, "simulate");
+        simulate.addBytes(input.size());
+        std::vector<int> symbolMap = dfsm.symbolMap();
+        int current = 0;
+        for (size_t i = 0; i < input.size(); i++) {
+            char ch = input.data()[i];
+            if (ch == '\n' || ch == ' ') continue;
+            int symbol = symbolMap[(unsigned char) ch];
+            if (symbol < 0) {
+                throw std::runtime_error(std::string("Character '") + ch + "' is not in the alphabet");
+            }
+            current = dfsm.next(current, symbol);
+        }
+        simulate.stop();
+        std::cout << (dfsm.accepting[current] ? "yes" : "no") << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    if (wantStats) stats.report();
     return 0;
 }
@@ -0,0 +1,75 @@
+// AhoCorasick Program
+// Builds a single DFSM that recognizes every literal pattern in PATTERN.txt
+// (one pattern per line) and scans input files with it.
+//
+// HOW TO RUN THE CODE:
+// >>g++ -std=c++17 -O2 -o AhoCorasick AhoCorasick.cpp
+// >>./AhoCorasick [--stats] build PATTERN.txt DFSM.txt
+// >>./AhoCorasick [--stats] scan DFSM.txt INPUT.txt
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "AhoCorasick.h"
+#include "Stats.h"
+
+int main(int argc, char* argv[]) {
+    bool wantStats = Stats::takeFlag(argc, argv);
+    Stats stats("AhoCorasick");
+    Stats* statsOut = wantStats ? &stats : nullptr;
+    std::string mode = argc == 4 ? argv[1] : "";
+    if (mode != "build" && mode != "scan") {
+        std::cerr << "Usage: " << argv[0] << " [--stats] build <pattern_file> <output DFSM file>\n"
+                  << "       " << argv[0] << " [--stats] scan <DFSM file> <input string file>" << std::endl;
+        return 1;
+    }
+
+    try {
+        if (mode == "build") {
+            Stats::Stage build(statsOut, "build");
+            build.addBytes(Stats::fileBytes(argv[2]));
+            DFSM dfsm = AhoCorasick::buildFromFile(argv[2]);
+            build.stop();
+            Stats::Stage write(statsOut, "write_dfsm");
+            dfsm.writeToFile(argv[3]);
+            write.stop();
+            stats.set("dfa_states", dfsm.numStates);
+            std::cout << "DFSM specification with " << dfsm.numStates << " states written to " << argv[3] << std::endl;
+            if (wantStats) stats.report();
+            return 0;
+        }
+
+        DFSM dfsm;
+        Stats::Stage read(statsOut, "read_dfsm");
+        dfsm.readFromFile(argv[2]);
+        read.stop();
+        stats.set("dfa_states", dfsm.numStates);
+        if (!dfsm.hasMatchIds()) {
+            throw std::runtime_error(std::string(argv[2]) + " has no match ID section");
+        }
+        std::ifstream input(argv[3], std::ios::binary);
+        if (!input) {
+            throw std::runtime_error(std::string("Could not open input file: ") + argv[3]);
+        }
+        std::stringstream contents;
+        contents << input.rdbuf();
+        std::string text = contents.str();
+
+        std::string out;
+        Stats::Stage scan(statsOut, "scan");
+        scan.addBytes(text.size());
+        size_t matches = AhoCorasick::scan(dfsm, text.data(), text.size(), [&](size_t end, int id) {
+            out += std::to_string(end) + " " + std::to_string(id) + "\n";
+        });
+        scan.stop();
+        stats.set("matches", matches);
+        std::cout << out << matches << " matches" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    if (wantStats) stats.report();
+    return 0;
+}
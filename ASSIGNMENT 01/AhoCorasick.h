@@ -0,0 +1,140 @@
+// AhoCorasick.h
+#ifndef AHOCORASICK_H
+#define AHOCORASICK_H
+
+#include <fstream>
+#include <vector>
+#include <string>
+#include <set>
+#include <stdexcept>
+#include <cctype>
+
+#include "DFSM.h"
+
+// Builds one DFSM for a whole set of literal patterns: a shared-prefix trie
+// with failure links, completed into a full transition table so scanning costs
+// one table lookup per input byte whatever the number of patterns.
+// Accepting states carry the IDs of every pattern that ends there.
+class AhoCorasick {
+public:
+    // Reads one pattern per line; a pattern's ID is its line number.
+    static DFSM buildFromFile(const std::string& patternFileName) {
+        std::ifstream reader(patternFileName);
+        if (!reader.is_open()) {
+            throw std::runtime_error("Could not open pattern file: " + patternFileName);
+        }
+
+        std::vector<std::string> patterns;
+        std::vector<int> ids;
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(reader, line)) {
+            lineNumber++;
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty()) continue;
+            patterns.push_back(line);
+            ids.push_back(lineNumber);
+        }
+        if (patterns.empty()) {
+            throw std::runtime_error("No patterns in " + patternFileName);
+        }
+        return build(patterns, ids);
+    }
+
+    static DFSM build(const std::vector<std::string>& patterns, const std::vector<int>& ids) {
+        // The alphabet is every symbol used by some pattern
+        std::set<char> symbols;
+        for (const auto& pattern : patterns) {
+            for (char c : pattern) {
+                if (isspace((unsigned char) c)) {
+                    throw std::runtime_error("Patterns cannot contain whitespace: \"" + pattern + "\"");
+                }
+                symbols.insert(c);
+            }
+        }
+
+        DFSM dfsm;
+        dfsm.alphabet.assign(symbols.begin(), symbols.end());
+        std::vector<int> symbolMap = dfsm.symbolMap();
+        int numSymbols = dfsm.numSymbols();
+
+        // Trie: -1 marks a missing edge until the failure pass fills it in
+        dfsm.addState();
+        std::fill(dfsm.transitions.begin(), dfsm.transitions.end(), -1);
+        std::vector<std::vector<int>> output(1);
+        for (size_t p = 0; p < patterns.size(); p++) {
+            int state = 0;
+            for (char c : patterns[p]) {
+                size_t cell = (size_t) state * numSymbols + symbolMap[(unsigned char) c];
+                if (dfsm.transitions[cell] < 0) {
+                    int child = dfsm.addState();
+                    std::fill(dfsm.transitions.end() - numSymbols, dfsm.transitions.end(), -1);
+                    output.emplace_back();
+                    dfsm.transitions[cell] = child;
+                }
+                state = dfsm.transitions[cell];
+            }
+            output[state].push_back(ids[p]);
+        }
+
+        // Breadth-first pass: every missing edge takes the edge of the failure
+        // state, which is shallower and therefore already complete
+        std::vector<int> failure(dfsm.numStates, 0);
+        std::vector<int> queue;
+        for (int symbol = 0; symbol < numSymbols; symbol++) {
+            int& target = dfsm.transitions[symbol];
+            if (target < 0) {
+                target = 0;
+            } else {
+                queue.push_back(target);
+            }
+        }
+        for (size_t head = 0; head < queue.size(); head++) {
+            int state = queue[head];
+            const std::vector<int>& inherited = output[failure[state]];
+            output[state].insert(output[state].end(), inherited.begin(), inherited.end());
+            for (int symbol = 0; symbol < numSymbols; symbol++) {
+                int& target = dfsm.transitions[(size_t) state * numSymbols + symbol];
+                int fallback = dfsm.next(failure[state], symbol);
+                if (target < 0) {
+                    target = fallback;
+                } else {
+                    failure[target] = fallback;
+                    queue.push_back(target);
+                }
+            }
+        }
+
+        for (int state = 0; state < dfsm.numStates; state++) {
+            dfsm.accepting[state] = !output[state].empty();
+        }
+        dfsm.setMatchIds(output);
+        return dfsm;
+    }
+
+    // Calls report(endOffset, patternId) for every occurrence, endOffset being
+    // the index of the last byte of the match. Bytes outside the alphabet can
+    // not be part of any pattern and return the scan to the start state.
+    template <typename Report>
+    static size_t scan(const DFSM& dfsm, const char* text, size_t length, Report report) {
+        std::vector<int> symbolMap = dfsm.symbolMap();
+        const int* table = dfsm.transitions.data();
+        const int* offsets = dfsm.matchOffsets.data();
+        size_t numSymbols = dfsm.numSymbols();
+        size_t matches = 0;
+        int state = 0;
+        for (size_t i = 0; i < length; i++) {
+            int symbol = symbolMap[(unsigned char) text[i]];
+            state = symbol < 0 ? 0 : table[(size_t) state * numSymbols + symbol];
+            if (offsets[state] != offsets[state + 1]) {
+                for (int m = offsets[state]; m < offsets[state + 1]; m++) {
+                    report(i, dfsm.matchIds[m]);
+                }
+                matches += offsets[state + 1] - offsets[state];
+            }
+        }
+        return matches;
+    }
+};
+
+#endif
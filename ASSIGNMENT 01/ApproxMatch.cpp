@@ -0,0 +1,113 @@
+// ApproxMatch Program
+// Tests whether an input string contains the pattern with at most k edit
+// errors (insertions, deletions or substitutions). Patterns of up to 64
+// characters run on the bit-parallel engine straight from the pattern; longer
+// ones, or any with --determinize, go through the Levenshtein NDFSM and a
+// minimal DFSM, which grows quickly with k: long patterns with k >= 2 can
+// take many seconds to determinize. With k at least the pattern length every
+// input matches, so no machine is run. --ndfsm also writes the Levenshtein
+// NDFSM to a file.
+//
+// The alphabet is the pattern's characters plus those given with -a; as in
+// the simulators, spaces and newlines are skipped and any other character
+// outside the alphabet is an error.
+//
+// HOW TO RUN THE CODE:
+// >>g++ -std=c++17 -O2 -o ApproxMatch ApproxMatch.cpp
+// >>./ApproxMatch [-k <errors>] [-a <alphabet>] [--determinize] [--ndfsm NFSM.txt] [--stats] <pattern> INPUT.txt
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+#include "NDFSMBuilder.h"
+#include "NDFSMtoDFSM.h"
+#include "ApproxMatcher.h"
+#include "DFSMEngine.h"
+#include "MappedFile.h"
+#include "Stats.h"
+
+int main(int argc, char* argv[]) {
+    bool wantStats = Stats::takeFlag(argc, argv);
+    Stats stats("ApproxMatch");
+    Stats* statsOut = wantStats ? &stats : nullptr;
+    int errors = 1;
+    std::string alphabet, ndfsmFile;
+    bool determinize = false;
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; arg++) {
+        std::string option = argv[arg];
+        if (option == "-k" && arg + 1 < argc && atoi(argv[arg + 1]) >= 0) {
+            errors = atoi(argv[++arg]);
+        } else if (option == "-a" && arg + 1 < argc) {
+            alphabet = argv[++arg];
+        } else if (option == "--determinize") {
+            determinize = true;
+        } else if (option == "--ndfsm" && arg + 1 < argc) {
+            ndfsmFile = argv[++arg];
+        } else {
+            arg = argc;
+        }
+    }
+    if (argc - arg != 2) {
+        std::cerr << "Usage: " << argv[0] << " [-k <errors>] [-a <alphabet>] [--determinize] [--ndfsm <NDFSM file>] [--stats] <pattern> <input string file>\n"
+                  << "Patterns over " << ApproxMatcher::maxPatternLength << " characters, and --determinize, build a DFSM; with k >= 2 that is slow for long patterns." << std::endl;
+        return 1;
+    }
+
+    std::string pattern = argv[arg];
+    try {
+        Stats::Stage build(statsOut, "build_ndfsm");
+        NDFSM ndfsm = NDFSMBuilder::buildApproximate(pattern, errors, alphabet);
+        build.stop();
+        stats.set("pattern_length", pattern.size());
+        stats.set("errors", errors);
+        stats.set("nfa_states", ndfsm.numStates());
+        if (!ndfsmFile.empty()) {
+            ndfsm.writeToFile(ndfsmFile);
+            std::cout << "NDFSM specification written to " << ndfsmFile << std::endl;
+        }
+
+        MappedFile input(argv[arg + 1]);
+        bool accepted;
+        if (errors >= (int) pattern.size()) {
+            // k deletions erase the whole pattern, so the empty string is an
+            // occurrence; the input is only checked against the alphabet
+            stats.set("bit_parallel", 0);
+            DFSM everything;
+            for (char c : ndfsm.alphabet) {
+                if (c != '$') everything.alphabet.push_back(c);
+            }
+            everything.addState();
+            everything.accepting[0] = 1;
+            Stats::Stage simulate(statsOut, "simulate");
+            simulate.addBytes(input.size());
+            withDFSMEngine(everything, InputPolicy(), smallPages, true, [&](const auto& engine) {
+                return engine.run(input.data(), input.size());
+            });
+            accepted = true;
+        } else if (!determinize && pattern.size() <= ApproxMatcher::maxPatternLength) {
+            stats.set("bit_parallel", 1);
+            ApproxMatcher matcher(pattern, errors, ndfsm.alphabet);
+            Stats::Stage simulate(statsOut, "simulate");
+            simulate.addBytes(input.size());
+            accepted = matcher.accepts(input.data(), input.size());
+        } else {
+            stats.set("bit_parallel", 0);
+            DFSM dfsm = NDFSMtoDFSM::convertToDFSM(ndfsm, 1, true, statsOut);
+            stats.set("dfa_states", dfsm.numStates);
+            Stats::Stage simulate(statsOut, "simulate");
+            simulate.addBytes(input.size());
+            int current = withDFSMEngine(dfsm, InputPolicy(), smallPages, true, [&](const auto& engine) {
+                return engine.run(input.data(), input.size());
+            });
+            accepted = dfsm.accepting[current];
+        }
+        std::cout << (accepted ? "yes" : "no") << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    if (wantStats) stats.report();
+    return 0;
+}
@@ -0,0 +1,127 @@
+// ApproxMatchTest Program
+// Checks approximate matching against Sellers' edit-distance search: on
+// random patterns of up to 64 characters, error counts from 0 to 6 and
+// random inputs with planted near-occurrences, ApproxMatcher and the
+// minimal DFSM of the Levenshtein NDFSM must say whether some substring is
+// within k edits of the pattern, and reject characters outside the alphabet.
+//
+// HOW TO RUN THE CODE:
+// >>g++ -std=c++17 -O2 -o ApproxMatchTest ApproxMatchTest.cpp
+// >>./ApproxMatchTest
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "NDFSMBuilder.h"
+#include "NDFSMtoDFSM.h"
+#include "ApproxMatcher.h"
+#include "DFSMEngine.h"
+#include "TestCheck.h"
+
+// Sellers: column i is the least edit distance between the first i pattern
+// characters and a substring ending at the current input symbol
+static bool sellers(const std::string& pattern, int errors, const std::string& text) {
+    size_t m = pattern.size();
+    std::vector<int> column(m + 1), next(m + 1);
+    for (size_t i = 0; i <= m; i++) column[i] = i;
+    if (column[m] <= errors) return true;
+    for (char c : text) {
+        if (c == ' ' || c == '\n') continue;
+        next[0] = 0;
+        for (size_t i = 1; i <= m; i++) {
+            next[i] = std::min({column[i - 1] + (pattern[i - 1] != c), column[i] + 1, next[i - 1] + 1});
+        }
+        column.swap(next);
+        if (column[m] <= errors) return true;
+    }
+    return false;
+}
+
+// Pattern with up to 'edits' random insertions, deletions and substitutions
+static std::string edited(std::mt19937& random, std::string text, int edits, const std::string& pool) {
+    for (int e = 0; e < edits; e++) {
+        size_t at = random() % (text.size() + 1);
+        switch (random() % 3) {
+            case 0: text.insert(at, 1, pool[random() % pool.size()]); break;
+            case 1: if (at < text.size()) text.erase(at, 1); break;
+            default: if (at < text.size()) text[at] = pool[random() % pool.size()]; break;
+        }
+    }
+    return text;
+}
+
+// 1 accepted, 0 rejected, -1 an error
+template <typename Run>
+static int outcome(Run run) {
+    try {
+        return run() ? 1 : 0;
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+int main() {
+    TestCheck check("ApproxMatchTest");
+    std::mt19937 random(49);
+    const std::vector<int> lengths = {1, 2, 3, 31, 32, 33, 63, 64};
+
+    for (int round = 0; round < 400; round++) {
+        int length = round < (int) lengths.size() ? lengths[round] : 1 + random() % 64;
+        std::string letters = round % 2 ? "abcd" : "ab";
+        std::string pattern = TestCheck::randomText(random, letters, length);
+        int errors = random() % 7;
+        std::string name = "pattern " + pattern + ", k = " + std::to_string(errors);
+
+        NDFSM ndfsm = NDFSMBuilder::buildApproximate(pattern, errors, "abcde");
+        ApproxMatcher matcher(pattern, errors, ndfsm.alphabet);
+
+        // Determinizing grows quickly with the pattern and k
+        DFSM dfsm;
+        bool determinize = length <= 8 && errors <= 3;
+        if (determinize) dfsm = NDFSMtoDFSM::convertToDFSM(ndfsm, 1, true);
+
+        std::string pool = "abcde \n";
+        for (int input = 0; input < 10; input++) {
+            std::string text = TestCheck::randomText(random, pool, random() % (input < 8 ? 200 : 6000));
+            if (random() % 2) {
+                size_t at = text.size() > 4096 && random() % 2 ? 4096 - random() % length : random() % (text.size() + 1);
+                text.insert(std::min(at, text.size()), edited(random, pattern, random() % (errors + 2), "abcde"));
+            }
+            if (random() % 8 == 0) text.insert(random() % (text.size() + 1), 1, 'x');
+
+            int reference = text.find('x') != std::string::npos ? -1 : sellers(pattern, errors, text);
+            std::string what = name + ", input " + std::to_string(input);
+            check.expect(outcome([&]() { return matcher.accepts(text.data(), text.size()); }) == reference, what + ": bit-parallel");
+            if (determinize) {
+                int determinized = outcome([&]() {
+                    int state = withDFSMEngine(dfsm, InputPolicy(), smallPages, true, [&](const auto& engine) {
+                        return engine.run(text.data(), text.size());
+                    });
+                    return (bool) dfsm.accepting[state];
+                });
+                check.expect(determinized == reference, what + ": determinized");
+            }
+        }
+    }
+
+    // Edge cases of the recurrence: the empty input, k at and past the
+    // pattern length, and a run of deletions at the end of the input
+    for (int errors = 0; errors <= 6; errors++) {
+        std::string name = "k = " + std::to_string(errors);
+        ApproxMatcher matcher("abcab", errors, {'a', 'b', 'c'});
+        check.expect(matcher.accepts("", 0) == (errors >= 5), name + ": empty input");
+        check.expect(matcher.accepts("  \n", 3) == (errors >= 5), name + ": blanks only");
+        check.expect(matcher.accepts("cccab", 5) == sellers("abcab", errors, "cccab"), name + ": suffix \"ab\"");
+        check.expect(matcher.accepts("abc", 3) == (errors >= 2), name + ": prefix \"abc\"");
+    }
+
+    ApproxMatcher wide(std::string(64, 'a'), 1, {'a', 'b'});
+    check.expect(wide.accepts(std::string(63, 'a').c_str(), 63), "64 characters, one deletion");
+    check.expect(!wide.accepts((std::string(31, 'a') + "bb" + std::string(31, 'a')).c_str(), 64), "64 characters, two substitutions");
+    check.expect(outcome([]() { return ApproxMatcher(std::string(65, 'a'), 1, {'a'}).accepts("a", 1); }) < 0,
+                 "pattern over 64 characters is refused");
+
+    return check.finish();
+}
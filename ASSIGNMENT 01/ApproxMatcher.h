@@ -0,0 +1,116 @@
+// ApproxMatcher.h
+#ifndef APPROXMATCHER_H
+#define APPROXMATCHER_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+
+// Bit-parallel run of the NDFSMBuilder::buildApproximate machine (Wu and
+// Manber): R[e] holds the states of row e as one word, bit i meaning that
+// i + 1 pattern characters are done with at most e errors. A step is
+//
+//   R'[0] = ((R[0] << 1) | 1) & mask[c]
+//   R'[e] = (((R[e] << 1) | 1) & mask[c])   pattern character
+//         | R[e - 1]                        insertion
+//         | (R[e - 1] << 1) | 1             substitution
+//         | (R'[e - 1] << 1)                deletion
+//
+// so a byte costs a few word operations per allowed error and nothing is
+// determinized. Patterns are limited to one word.
+class ApproxMatcher {
+public:
+    static const size_t maxPatternLength = 64;
+
+    ApproxMatcher(const std::string& pattern, int errors, const std::vector<char>& alphabet)
+        : errors(errors), masks(256, 0), known(256, 0) {
+        if (pattern.empty() || pattern.size() > maxPatternLength) {
+            throw std::runtime_error("Pattern length must be between 1 and " + std::to_string(maxPatternLength));
+        }
+        lastBit = 1ULL << (pattern.size() - 1);
+        for (char c : alphabet) {
+            if (c != '$') known[(unsigned char) c] = 1;
+        }
+        for (size_t i = 0; i < pattern.size(); i++) {
+            masks[(unsigned char) pattern[i]] |= 1ULL << i;
+        }
+    }
+
+    // Runs the whole input like the DFSM simulators: blanks and newlines are
+    // skipped and any other byte outside the alphabet is an error
+    bool accepts(const char* text, size_t length) const {
+        switch (errors) {
+            case 0: return run<0>(text, length);
+            case 1: return run<1>(text, length);
+            case 2: return run<2>(text, length);
+            case 3: return run<3>(text, length);
+            default: return run<-1>(text, length);
+        }
+    }
+
+private:
+    int errors;
+    uint64_t lastBit;
+    std::vector<uint64_t> masks; // Pattern positions holding each byte
+    std::vector<char> known;     // Bytes in the alphabet
+
+    static const size_t chunk = 4096;
+
+    // 'Fixed' is the error count when it is small enough to unroll the rows
+    // into registers, -1 to use 'errors' at run time
+    template <int Fixed>
+    bool run(const char* text, size_t length) const {
+        const int count = Fixed >= 0 ? Fixed : errors;
+        uint64_t fixedRows[Fixed >= 0 ? Fixed + 1 : 1];
+        std::vector<uint64_t> rows(Fixed >= 0 ? 0 : errors + 1);
+        uint64_t* r = Fixed >= 0 ? fixedRows : rows.data();
+
+        // Before any input, e deletions cover the first e pattern characters
+        for (int e = 0; e <= count; e++) {
+            r[e] = e >= 64 ? ~0ULL : (1ULL << e) - 1;
+        }
+        bool found = r[count] & lastBit;
+        size_t i = 0;
+        while (i < length && !found) {
+            size_t end = std::min(i + chunk, length);
+            uint8_t bad = 0;
+            for (; i < end; i++) {
+                unsigned char ch = text[i];
+                if (ch == '\n' || ch == ' ') continue;
+                bad |= !known[ch];
+                uint64_t mask = masks[ch];
+                uint64_t previous = r[0];
+                r[0] = ((r[0] << 1) | 1) & mask;
+                for (int e = 1; e <= count; e++) {
+                    uint64_t current = r[e];
+                    r[e] = (((current << 1) | 1) & mask) | previous | ((previous | r[e - 1]) << 1) | 1;
+                    previous = current;
+                }
+                if (r[count] & lastBit) {
+                    found = true;
+                    i++;
+                    break;
+                }
+            }
+            if (bad) checkAlphabet(text, i);
+        }
+
+        // Once a match is found the answer is fixed; the rest of the input is
+        // only checked against the alphabet
+        checkAlphabet(text + i, length - i);
+        return found;
+    }
+
+    void checkAlphabet(const char* text, size_t length) const {
+        for (size_t i = 0; i < length; i++) {
+            unsigned char ch = text[i];
+            if (ch != '\n' && ch != ' ' && !known[ch]) {
+                throw std::runtime_error(std::string("Character '") + (char) ch + "' is not in the alphabet");
+            }
+        }
+    }
+};
+
+#endif
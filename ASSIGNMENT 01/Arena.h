@@ -0,0 +1,85 @@
+// Arena.h
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Monotonic allocator: memory is handed out by bumping a pointer through
+// large blocks and is only given back all at once, by reset() or by the
+// destructor. Meant for objects that live exactly as long as one conversion,
+// such as interned state sets, so only trivially copyable types are allowed
+// and nothing is ever destroyed individually. Pointers stay valid until the
+// next reset().
+class Arena {
+public:
+    explicit Arena(size_t blockBytes = 1 << 20) : blockBytes(blockBytes) {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    template <typename T>
+    T* allocate(size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value, "Arena holds trivially copyable types only");
+        size_t bytes = count * sizeof(T);
+        size_t start = (used + alignof(T) - 1) & ~(alignof(T) - 1);
+        if (current == blocks.size() || start + bytes > blocks[current].size) {
+            nextBlock(bytes + alignof(T));
+            start = (used + alignof(T) - 1) & ~(alignof(T) - 1);
+        }
+        used = start + bytes;
+        requests++;
+        return reinterpret_cast<T*>(blocks[current].data.get() + start);
+    }
+
+    template <typename T>
+    T* copy(const T* data, size_t count) {
+        T* out = allocate<T>(count);
+        if (count) memcpy(out, data, count * sizeof(T));
+        return out;
+    }
+
+    // Forgets every allocation but keeps the blocks for reuse
+    void reset() {
+        current = 0;
+        used = 0;
+    }
+
+    // Bytes in blocks obtained from the heap, and the number of those blocks
+    size_t reservedBytes() const { return reserved; }
+    size_t numBlocks() const { return blocks.size(); }
+    uint64_t numRequests() const { return requests; }
+
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    size_t blockBytes;
+    std::vector<Block> blocks;
+    size_t current = 0; // Block being filled; blocks.size() before the first allocation
+    size_t used = 0;    // Bytes used in the current block
+    size_t reserved = 0;
+    uint64_t requests = 0;
+
+    // Moves on to the next kept block that fits, or adds a block; oversized
+    // requests get a block of their own
+    void nextBlock(size_t bytes) {
+        size_t next = current == blocks.size() ? 0 : current + 1;
+        while (next < blocks.size() && blocks[next].size < bytes) next++;
+        if (next == blocks.size()) {
+            size_t size = bytes > blockBytes ? bytes : blockBytes;
+            blocks.push_back({std::unique_ptr<char[]>(new char[size]), size});
+            reserved += size;
+        }
+        current = next;
+        used = 0;
+    }
+};
+
+#endif
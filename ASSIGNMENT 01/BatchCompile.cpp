@@ -0,0 +1,190 @@
+// BatchCompile Program
+// Compiles every pattern in a pattern file (one per line, empty lines skipped)
+// into its own minimal DFSM, several patterns at a time. Each pattern goes
+// through the same stages as A2B: build the NDFSM, convert it, minimize it
+// and write it. A pattern that fails is reported and the others carry on.
+//
+// The output directory receives pattern_<line>.dfsm for every compiled
+// pattern (binary DFSM files, or text with --text) and MANIFEST.txt with one
+// line per pattern: "<line> ok <states> <file>" or "<line> error <message>".
+//
+// HOW TO RUN THE CODE:
+// >>g++ -std=c++17 -O2 -pthread -o BatchCompile BatchCompile.cpp
+// >>./BatchCompile [-j <threads>] [--text] [--stats] PATTERN.txt compiled/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+
+#include "NDFSMBuilder.h"
+#include "NDFSMtoDFSM.h"
+#include "DFSMMinimizer.h"
+#include "MappedFile.h"
+#include "Stats.h"
+
+enum Stage { buildStage, convertStage, minimizeStage, writeStage, numStages };
+static const char* stageNames[numStages] = {"build", "convert", "minimize", "write"};
+
+struct PatternResult {
+    int line = 0;
+    bool ok = false;
+    int nfaStates = 0;
+    int states = 0;
+    std::string detail; // Output file, or the error message
+};
+
+int main(int argc, char* argv[]) {
+    bool wantStats = Stats::takeFlag(argc, argv);
+    Stats stats("BatchCompile");
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    bool text = false;
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; arg++) {
+        std::string option = argv[arg];
+        if (option == "-j" && arg + 1 < argc) {
+            threads = std::max(1, atoi(argv[++arg]));
+        } else if (option == "--text") {
+            text = true;
+        } else {
+            arg = argc;
+        }
+    }
+    if (argc - arg != 2) {
+        std::cerr << "Usage: " << argv[0] << " [-j <threads>] [--text] [--stats] <pattern_file> <output directory>" << std::endl;
+        return 1;
+    }
+    std::filesystem::path outputDirectory = argv[arg + 1];
+
+    std::vector<std::string> patterns;
+    std::vector<int> lines;
+    try {
+        MappedFile file(argv[arg]);
+        const char* p = file.data();
+        const char* end = p + file.size();
+        for (int line = 1; p < end; line++) {
+            const char* lineEnd = std::find(p, end, '\n');
+            std::string pattern(p, lineEnd);
+            if (!pattern.empty() && pattern.back() == '\r') pattern.pop_back();
+            if (!pattern.empty()) {
+                patterns.push_back(pattern);
+                lines.push_back(line);
+            }
+            p = lineEnd + (lineEnd < end);
+        }
+        std::filesystem::create_directories(outputDirectory);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<PatternResult> results(patterns.size());
+    std::vector<std::vector<double>> stageSeconds(threads, std::vector<double>(numStages, 0.0));
+    std::vector<std::vector<double>> stageCpuSeconds(threads, std::vector<double>(numStages, 0.0));
+    std::atomic<size_t> nextPattern(0);
+
+    auto worker = [&](int thread) {
+        for (;;) {
+            size_t index = nextPattern.fetch_add(1);
+            if (index >= patterns.size()) break;
+            PatternResult& result = results[index];
+            result.line = lines[index];
+
+            auto stageStart = std::chrono::steady_clock::now();
+            double cpuStart = Stats::threadCpuSeconds();
+            auto endStage = [&](Stage stage) {
+                auto now = std::chrono::steady_clock::now();
+                double cpuNow = Stats::threadCpuSeconds();
+                stageSeconds[thread][stage] += std::chrono::duration<double>(now - stageStart).count();
+                stageCpuSeconds[thread][stage] += cpuNow - cpuStart;
+                stageStart = now;
+                cpuStart = cpuNow;
+            };
+
+            // Any failure stays with its pattern
+            try {
+                NDFSM ndfsm = NDFSMBuilder::build(patterns[index]);
+                result.nfaStates = ndfsm.numStates();
+                endStage(buildStage);
+                DFSM dfsm = NDFSMtoDFSM::convertToDFSM(ndfsm);
+                endStage(convertStage);
+                dfsm = DFSMMinimizer::minimize(dfsm);
+                endStage(minimizeStage);
+                std::string fileName = "pattern_" + std::to_string(result.line) + ".dfsm";
+                std::string path = (outputDirectory / fileName).string();
+                if (text) {
+                    dfsm.writeToFile(path);
+                } else {
+                    dfsm.writeBinaryFile(path);
+                }
+                endStage(writeStage);
+                result.ok = true;
+                result.states = dfsm.numStates;
+                result.detail = fileName;
+            } catch (const std::exception& e) {
+                result.detail = e.what();
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; t++) {
+        pool.emplace_back(worker, t);
+    }
+    worker(0);
+    for (auto& thread : pool) thread.join();
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int failed = 0;
+    std::string manifest;
+    for (const PatternResult& result : results) {
+        manifest += std::to_string(result.line);
+        if (result.ok) {
+            manifest += " ok " + std::to_string(result.states) + " " + result.detail + "\n";
+        } else {
+            manifest += " error " + result.detail + "\n";
+            std::cerr << "Error: pattern on line " << result.line << ": " << result.detail << std::endl;
+            failed++;
+        }
+    }
+    std::ofstream writer(outputDirectory / "MANIFEST.txt");
+    writer << manifest;
+    if (!writer) {
+        std::cerr << "Error: Cannot write the manifest in " << outputDirectory.string() << std::endl;
+        return 1;
+    }
+
+    // Stage times are summed over all threads, so with -j above 1 they can exceed the wall time
+    std::cout << "Compiled " << patterns.size() - failed << " of " << patterns.size() << " patterns into "
+              << outputDirectory.string() << " with " << threads << " threads in " << wall << " s" << std::endl;
+    for (int stage = 0; stage < numStages; stage++) {
+        double seconds = 0, cpuSeconds = 0;
+        for (int t = 0; t < threads; t++) {
+            seconds += stageSeconds[t][stage];
+            cpuSeconds += stageCpuSeconds[t][stage];
+        }
+        std::cout << "  " << stageNames[stage] << ": " << seconds << " s" << std::endl;
+        stats.addStage(stageNames[stage], seconds, cpuSeconds, 0);
+    }
+
+    if (wantStats) {
+        int64_t nfaStates = 0, dfaStates = 0;
+        for (const PatternResult& result : results) {
+            nfaStates += result.nfaStates;
+            dfaStates += result.states;
+        }
+        stats.set("patterns", patterns.size());
+        stats.set("failed", failed);
+        stats.set("threads", threads);
+        stats.set("nfa_states", nfaStates);
+        stats.set("dfa_states", dfaStates);
+        stats.report();
+    }
+    return failed ? 2 : 0;
+}
@@ -0,0 +1,240 @@
+// BitNFA.h
+#ifndef BITNFA_H
+#define BITNFA_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <stdexcept>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "NDFSM.h"
+#include "EpsilonClosure.h"
+
+// Runs an NDFSM without determinizing it by keeping the set of active states
+// as a bitset.
+//
+// Pattern NFAs written by NDFSMBuilder are a chain: state 1 loops on every
+// symbol, state i+1 follows state i on one pattern character, and the last
+// state is accepting. For those the bit of state i+1 moves to i+2 on a match,
+// so a step is the Shift-And update D = ((D << 1) | 1) & mask[symbol] over
+// one word per 64 pattern characters.
+//
+// Any other NDFSM uses precomputed successor rows: for every state and symbol
+// the epsilon-closed set of targets as a bitset. A step ORs the rows of the
+// active states together, a whole vector register at a time.
+class BitNFA {
+public:
+    // Successor rows beyond this size are refused; determinize instead
+    static const size_t maxRowBytes = (size_t) 256 << 20;
+
+    explicit BitNFA(const NDFSM& ndfsm)
+        : numSymbols(ndfsm.numSymbols()), symbolMap(256, -1) {
+        for (int i = 0; i < numSymbols; i++) {
+            symbolMap[(unsigned char) ndfsm.alphabet[i]] = i;
+        }
+        if (!buildShiftAnd(ndfsm)) {
+            buildRows(ndfsm);
+        }
+    }
+
+    bool isShiftAnd() const { return shiftAnd; }
+    size_t numWords() const { return words; }
+    size_t rowBytes() const { return rows.size() * sizeof(uint64_t); }
+
+    // Runs the whole input like the DFSM simulators: blanks and newlines are
+    // skipped and any other byte outside the alphabet is an error
+    bool accepts(const char* text, size_t length) {
+        return shiftAnd ? runShiftAnd(text, length) : runRows(text, length);
+    }
+
+private:
+    int numSymbols;
+    std::vector<int> symbolMap;
+    bool shiftAnd = false;
+    size_t words = 0;
+
+    // Shift-And: one mask of 'words' words per symbol; bit i stands for NDFSM state i + 2
+    std::vector<uint64_t> masks;
+    size_t patternLength = 0;
+    bool finalLoops = false; // The accepting state keeps itself once reached
+
+    // Row engine: rowIndex[state * numSymbols + symbol] is a row number or -1 for no targets
+    std::vector<int> rowIndex;
+    std::vector<uint64_t> rows;
+    std::vector<uint64_t> start, acceptMask;
+
+    int symbolOf(char ch) const {
+        int symbol = symbolMap[(unsigned char) ch];
+        if (symbol < 0) {
+            throw std::runtime_error(std::string("Character '") + ch + "' is not in the alphabet");
+        }
+        return symbol;
+    }
+
+    static bool isOnly(NDFSM::Targets targets, int state) {
+        return targets.size() == 1 && targets.begin()[0] == state;
+    }
+
+    // Recognizes the NDFSMBuilder chain and builds the Shift-And masks
+    bool buildShiftAnd(const NDFSM& ndfsm) {
+        int n = ndfsm.numStates();
+        if (n < 2 || ndfsm.acceptingStates.size() != 1 || *ndfsm.acceptingStates.begin() != n - 1) return false;
+        for (int s = 0; s < n; s++) {
+            if (!ndfsm.epsilonTargets(s).empty()) return false;
+        }
+
+        size_t m = n - 1;
+        std::vector<int> pattern(m, -1);
+        for (int symbol = 0; symbol < numSymbols; symbol++) {
+            NDFSM::Targets first = ndfsm.targets(0, symbol);
+            if (first.size() == 2 && first.begin()[0] == 0 && first.begin()[1] == 1) {
+                if (pattern[0] >= 0) return false;
+                pattern[0] = symbol;
+            } else if (!isOnly(first, 0)) {
+                return false;
+            }
+            for (size_t s = 1; s < m; s++) {
+                NDFSM::Targets next = ndfsm.targets(s, symbol);
+                if (next.empty()) continue;
+                if (pattern[s] >= 0 || !isOnly(next, s + 1)) return false;
+                pattern[s] = symbol;
+            }
+        }
+        for (int p : pattern) {
+            if (p < 0) return false;
+        }
+
+        // The accepting state either loops on everything or has no moves at all
+        bool loops = true, empty = true;
+        for (int symbol = 0; symbol < numSymbols; symbol++) {
+            NDFSM::Targets last = ndfsm.targets(m, symbol);
+            loops = loops && isOnly(last, m);
+            empty = empty && last.empty();
+        }
+        if (!loops && !empty) return false;
+
+        shiftAnd = true;
+        finalLoops = loops;
+        patternLength = m;
+        words = (m + 63) / 64;
+        masks.assign((size_t) numSymbols * words, 0);
+        for (size_t i = 0; i < m; i++) {
+            masks[(size_t) pattern[i] * words + i / 64] |= 1ULL << (i % 64);
+        }
+        return true;
+    }
+
+    bool runShiftAnd(const char* text, size_t length) const {
+        size_t last = patternLength - 1;
+        uint64_t lastBit = 1ULL << (last % 64);
+        size_t i = 0;
+        bool found = false;
+
+        if (words == 1) {
+            uint64_t d = 0;
+            for (; i < length && !found; i++) {
+                char ch = text[i];
+                if (ch == '\n' || ch == ' ') continue;
+                d = ((d << 1) | 1) & masks[symbolOf(ch)];
+                found = finalLoops && (d & lastBit);
+            }
+            if (!found) return d & lastBit;
+        } else {
+            std::vector<uint64_t> d(words, 0);
+            for (; i < length && !found; i++) {
+                char ch = text[i];
+                if (ch == '\n' || ch == ' ') continue;
+                const uint64_t* mask = &masks[(size_t) symbolOf(ch) * words];
+                for (size_t w = words - 1; w > 0; w--) {
+                    d[w] = ((d[w] << 1) | (d[w - 1] >> 63)) & mask[w];
+                }
+                d[0] = ((d[0] << 1) | 1) & mask[0];
+                found = finalLoops && (d[last / 64] & lastBit);
+            }
+            if (!found) return d[last / 64] & lastBit;
+        }
+
+        // Once the looping accepting state is reached the answer is fixed;
+        // the rest of the input is only checked against the alphabet
+        for (; i < length; i++) {
+            char ch = text[i];
+            if (ch != '\n' && ch != ' ') symbolOf(ch);
+        }
+        return true;
+    }
+
+    void buildRows(const NDFSM& ndfsm) {
+        int n = ndfsm.numStates();
+        words = (n + 63) / 64;
+        EpsilonClosure closures(ndfsm);
+
+        rowIndex.assign((size_t) n * numSymbols, -1);
+        size_t lo = 0, hi = 0;
+        for (int s = 0; s < n; s++) {
+            for (int symbol = 0; symbol < numSymbols; symbol++) {
+                NDFSM::Targets targets = ndfsm.targets(s, symbol);
+                if (targets.empty()) continue;
+                if ((rows.size() + words) * sizeof(uint64_t) > maxRowBytes) {
+                    throw std::runtime_error("NDFSM with " + std::to_string(n) + " states is too large for the bitset engine");
+                }
+                rowIndex[(size_t) s * numSymbols + symbol] = rows.size() / words;
+                rows.resize(rows.size() + words, 0);
+                uint64_t* row = &rows[rows.size() - words];
+                for (int target : targets) {
+                    closures.orInto(target, row, lo, hi);
+                }
+            }
+        }
+
+        start.assign(words, 0);
+        closures.orInto(0, start.data(), lo, hi);
+        acceptMask.assign(words, 0);
+        for (int state : ndfsm.acceptingStates) {
+            acceptMask[state / 64] |= 1ULL << (state % 64);
+        }
+    }
+
+    static void orRow(uint64_t* __restrict target, const uint64_t* __restrict source, size_t count) {
+        size_t w = 0;
+#ifdef __SSE2__
+        for (; w + 2 <= count; w += 2) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(target + w));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + w));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(target + w), _mm_or_si128(a, b));
+        }
+#endif
+        for (; w < count; w++) {
+            target[w] |= source[w];
+        }
+    }
+
+    bool runRows(const char* text, size_t length) const {
+        std::vector<uint64_t> current = start, next(words);
+        for (size_t i = 0; i < length; i++) {
+            char ch = text[i];
+            if (ch == '\n' || ch == ' ') continue;
+            int symbol = symbolOf(ch);
+            std::fill(next.begin(), next.end(), 0);
+            for (size_t w = 0; w < words; w++) {
+                uint64_t word = current[w];
+                while (word) {
+                    size_t state = w * 64 + __builtin_ctzll(word);
+                    word &= word - 1;
+                    int row = rowIndex[state * numSymbols + symbol];
+                    if (row >= 0) orRow(next.data(), &rows[(size_t) row * words], words);
+                }
+            }
+            current.swap(next);
+        }
+        for (size_t w = 0; w < words; w++) {
+            if (current[w] & acceptMask[w]) return true;
+        }
+        return false;
+    }
+};
+
+#endif
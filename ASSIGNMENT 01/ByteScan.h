@@ -0,0 +1,110 @@
+// ByteScan.h
+#ifndef BYTESCAN_H
+#define BYTESCAN_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// A set of bytes kept as a few inclusive ranges, small enough to test
+// sixteen bytes at a time with SSE2 compares
+struct ByteRanges {
+    static const int maxRanges = 4;
+
+    int count = 0;
+    uint8_t low[maxRanges];
+    uint8_t width[maxRanges]; // High end minus low end
+
+    bool contains(unsigned char ch) const {
+        for (int r = 0; r < count; r++) {
+            if ((uint8_t) (ch - low[r]) <= width[r]) return true;
+        }
+        return false;
+    }
+
+    // Builds the ranges of a membership table; false when more than maxRanges are needed
+    bool assign(const bool member[256]) {
+        count = 0;
+        for (int b = 0; b < 256;) {
+            if (!member[b]) {
+                b++;
+                continue;
+            }
+            int first = b;
+            while (b < 256 && member[b]) b++;
+            if (count == maxRanges) return false;
+            low[count] = first;
+            width[count] = b - 1 - first;
+            count++;
+        }
+        return true;
+    }
+};
+
+// First byte in [text, end) outside the ranges, or end if there is none
+inline const char* findOutside(const char* text, const char* end, const ByteRanges& ranges) {
+    const char* p = text;
+#ifdef __SSE2__
+    __m128i low[ByteRanges::maxRanges], width[ByteRanges::maxRanges];
+    for (int r = 0; r < ranges.count; r++) {
+        low[r] = _mm_set1_epi8((char) ranges.low[r]);
+        width[r] = _mm_set1_epi8((char) ranges.width[r]);
+    }
+    // A byte is inside a range when (byte - low) <= width as unsigned, that is when min() leaves it unchanged
+    for (; end - p >= 16; p += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i inside = _mm_setzero_si128();
+        for (int r = 0; r < ranges.count; r++) {
+            __m128i offset = _mm_sub_epi8(bytes, low[r]);
+            inside = _mm_or_si128(inside, _mm_cmpeq_epi8(_mm_min_epu8(offset, width[r]), offset));
+        }
+        int outside = _mm_movemask_epi8(inside) ^ 0xFFFF;
+        if (outside) return p + __builtin_ctz(outside);
+    }
+#endif
+    while (p < end && ranges.contains(*p)) p++;
+    return p;
+}
+
+// First occurrence of a byte in [text, end), or end
+inline const char* findByte(const char* text, const char* end, unsigned char ch) {
+    const void* found = memchr(text, ch, end - text);
+    return found ? static_cast<const char*>(found) : end;
+}
+
+// First occurrence of a literal in [text, end), or end. Start positions
+// where both the first and the last byte of the literal match are found
+// sixteen at a time; memcmp confirms the bytes in between.
+inline const char* findLiteral(const char* text, const char* end, const std::string& literal) {
+    size_t length = literal.size();
+    if (length == 0) return text;
+    if ((size_t) (end - text) < length) return end;
+    if (length == 1) return findByte(text, end, literal[0]);
+    const char* last = end - length; // Last possible start
+    const char* p = text;
+#ifdef __SSE2__
+    __m128i first = _mm_set1_epi8(literal[0]);
+    __m128i final = _mm_set1_epi8(literal[length - 1]);
+    for (; last - p >= 15; p += 16) {
+        __m128i starts = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i ends = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + length - 1));
+        int candidates = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(starts, first), _mm_cmpeq_epi8(ends, final)));
+        while (candidates) {
+            int bit = __builtin_ctz(candidates);
+            if (memcmp(p + bit + 1, literal.data() + 1, length - 2) == 0) return p + bit;
+            candidates &= candidates - 1;
+        }
+    }
+#endif
+    for (; p <= last; p++) {
+        if (*p == literal[0] && memcmp(p, literal.data(), length) == 0) return p;
+    }
+    return end;
+}
+
+#endif
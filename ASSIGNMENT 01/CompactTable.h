@@ -0,0 +1,72 @@
+// CompactTable.h
+#ifndef COMPACTTABLE_H
+#define COMPACTTABLE_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "DFSM.h"
+#include "HugePages.h"
+
+// Copy of a DFSM's transition table with the state numbers stored as StateId
+// instead of int. With uint8_t or uint16_t a small or mid-size machine takes
+// a quarter or half of the cache it needs as a DFSM, often enough to stay in
+// L1 or L2. Large tables can be placed in huge pages; like any page, those
+// belong to the NUMA node of the thread that builds the table.
+template <typename StateId>
+class CompactTable {
+public:
+    explicit CompactTable(const DFSM& dfsm, PagePolicy policy = smallPages)
+        : numSymbols(dfsm.numSymbols()), count(dfsm.transitions.size()) {
+        StateId* out;
+        if (policy == smallPages) {
+            heap.resize(count);
+            out = heap.data();
+        } else {
+            pages = PagedBuffer(count * sizeof(StateId), policy);
+            out = reinterpret_cast<StateId*>(pages.data());
+        }
+        for (size_t i = 0; i < count; i++) {
+            out[i] = (StateId) dfsm.transitions[i];
+        }
+        rows = out;
+    }
+
+    CompactTable(const CompactTable&) = delete;
+    CompactTable& operator=(const CompactTable&) = delete;
+
+    int next(int state, int symbol) const { return rows[(size_t) state * numSymbols + symbol]; }
+
+    size_t bytes() const { return count * sizeof(StateId); }
+
+    // Page policy in effect; the huge-backed bytes are 0 for a heap table
+    PagePolicy policy() const { return pages.data() ? pages.policy() : smallPages; }
+    size_t hugeBackedBytes() const { return pages.data() ? pages.hugeBackedBytes() : 0; }
+
+private:
+    size_t numSymbols;
+    size_t count;
+    std::vector<StateId> heap; // Storage with small pages
+    PagedBuffer pages;         // Storage with huge pages
+    const StateId* rows;
+};
+
+// Bytes per state number for a machine with this many states
+inline int stateIdBytes(int numStates) {
+    return numStates <= 0x100 ? 1 : numStates <= 0x10000 ? 2 : 4;
+}
+
+// Calls f with a value of the narrowest state ID type for the state count, so
+// a generic lambda instantiates its hot loop once per width and the choice is
+// made once per machine rather than per symbol
+template <typename F>
+auto forStateWidth(int numStates, F&& f) {
+    switch (stateIdBytes(numStates)) {
+        case 1: return f(uint8_t());
+        case 2: return f(uint16_t());
+        default: return f(uint32_t());
+    }
+}
+
+#endif
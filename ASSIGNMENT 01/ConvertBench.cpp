@@ -0,0 +1,226 @@
+// ConvertBench Program
+// Measures how NDFSM-to-DFSM conversion scales on generated NDFSM families:
+//
+//   nth-from-end  the n-th symbol from the end is 'a' (2^n DFSM states)
+//   eps-chain     n states in epsilon chains of 256, with short epsilon cycles
+//   literal       NDFSMBuilder pattern NDFSMs for random patterns of length n
+//   random        random sparse NDFSMs over {a, b, c} with a few epsilon moves
+//
+// Each case runs in a child process, so its peak memory is its own and a case
+// that blows up is stopped by the timeout or the memory limit without taking
+// the suite down. A family stops growing at its first such case. Times are
+// given per stage: epsilon closure, subset construction, minimization and
+// serialization of the DFSM to text, and the conversion's heap allocations
+// are counted.
+//
+// HOW TO RUN THE CODE:
+// >>g++ -std=c++17 -O2 -pthread -o ConvertBench ConvertBench.cpp
+// >>./ConvertBench [--family <name>] [--timeout <seconds>] [--max-mb <megabytes>] [-j <threads>]
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <csignal>
+#include <new>
+#include <atomic>
+
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "NDFSMBuilder.h"
+#include "NDFSMtoDFSM.h"
+#include "DFSMMinimizer.h"
+#include "Stats.h"
+
+// Every operator new in the process is counted, so a case can report how
+// many heap allocations its conversion made. The count is atomic since the
+// threads of a -j conversion allocate too. The operators stay out of line so
+// GCC does not pair an inlined malloc with the standard operator new.
+static std::atomic<uint64_t> heapAllocations(0);
+
+__attribute__((noinline)) void* operator new(size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept { free(p); }
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept { free(p); }
+
+// Generators; every machine uses the alphabet "a b [c] $"
+static NDFSM nthFromEnd(int n) {
+    NDFSM ndfsm;
+    ndfsm.alphabet = {'a', 'b', '$'};
+    for (int i = 0; i <= n; i++) ndfsm.addState();
+    ndfsm.addDefaultTransition(0, 0);
+    ndfsm.addTransition(0, 0, 1);
+    for (int i = 1; i < n; i++) ndfsm.addDefaultTransition(i, i + 1);
+    ndfsm.acceptingStates.insert(n);
+    ndfsm.finish();
+    return ndfsm;
+}
+
+static NDFSM epsilonChain(int n) {
+    NDFSM ndfsm;
+    ndfsm.alphabet = {'a', 'b', '$'};
+    int epsilon = ndfsm.epsilonIndex();
+    for (int i = 0; i < n; i++) ndfsm.addState();
+    for (int i = 0; i < n; i++) {
+        if (i % 256 != 255 && i + 1 < n) ndfsm.addTransition(i, epsilon, i + 1); // Chains of 256 states
+        if (i % 16 == 15) ndfsm.addTransition(i, epsilon, i - 15); // Short cycles for the SCC pass
+        ndfsm.addTransition(i, i % 2, (int) ((i * 7919LL + 3) % n));
+    }
+    ndfsm.acceptingStates.insert(n - 1);
+    ndfsm.finish();
+    return ndfsm;
+}
+
+static NDFSM literal(int n) {
+    std::mt19937 random(n);
+    std::string pattern;
+    for (int i = 0; i < n; i++) pattern += "acgt"[random() % 4];
+    return NDFSMBuilder::build(pattern);
+}
+
+static NDFSM randomSparse(int n) {
+    std::mt19937 random(n);
+    NDFSM ndfsm;
+    ndfsm.alphabet = {'a', 'b', 'c', '$'};
+    for (int i = 0; i < n; i++) ndfsm.addState();
+    for (int i = 0; i < n; i++) {
+        for (int symbol = 0; symbol < ndfsm.numSymbols(); symbol++) {
+            int targets = random() % 3; // 0, 1 or 2 targets per cell
+            for (int t = 0; t < targets; t++) ndfsm.addTransition(i, symbol, random() % n);
+        }
+        if (random() % 8 == 0) ndfsm.addTransition(i, ndfsm.epsilonIndex(), random() % n);
+        if (random() % 10 == 0) ndfsm.acceptingStates.insert(i);
+    }
+    ndfsm.acceptingStates.insert(n - 1);
+    ndfsm.finish();
+    return ndfsm;
+}
+
+struct Family {
+    const char* name;
+    NDFSM (*generate)(int);
+    std::vector<int> sizes;
+};
+
+// Numbers the child reports back to the parent
+struct CaseResult {
+    int nfaStates, dfaStates, minimalStates;
+    double closureSeconds, subsetSeconds, minimizeSeconds, writeSeconds;
+    uint64_t convertAllocations, writtenBytes;
+};
+
+static CaseResult runCase(const Family& family, int n, int threads) {
+    NDFSM ndfsm = family.generate(n);
+    Stats stats(family.name);
+    uint64_t allocationsBefore = heapAllocations.load(std::memory_order_relaxed);
+    DFSM dfsm = NDFSMtoDFSM::convertToDFSM(ndfsm, threads, &stats);
+    uint64_t convertAllocations = heapAllocations.load(std::memory_order_relaxed) - allocationsBefore;
+
+    auto start = std::chrono::steady_clock::now();
+    DFSM minimal = DFSMMinimizer::minimize(dfsm);
+    double minimizeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    std::ostringstream out;
+    dfsm.write(out);
+    double writeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    return CaseResult{ndfsm.numStates(), dfsm.numStates, minimal.numStates,
+                      stats.stageSeconds("epsilon_closure"), stats.stageSeconds("subset_construction"),
+                      minimizeSeconds, writeSeconds, convertAllocations, (uint64_t) out.str().size()};
+}
+
+int main(int argc, char* argv[]) {
+    std::string only;
+    double timeout = 10;
+    long maxMegabytes = 4096;
+    int threads = 1;
+    for (int arg = 1; arg < argc; arg++) {
+        std::string option = argv[arg];
+        if (option == "--family" && arg + 1 < argc) {
+            only = argv[++arg];
+        } else if (option == "--timeout" && arg + 1 < argc) {
+            timeout = atof(argv[++arg]);
+        } else if (option == "--max-mb" && arg + 1 < argc) {
+            maxMegabytes = atol(argv[++arg]);
+        } else if (option == "-j" && arg + 1 < argc) {
+            threads = std::max(1, atoi(argv[++arg]));
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--family <name>] [--timeout <seconds>] [--max-mb <megabytes>] [-j <threads>]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<Family> families = {
+        {"nth-from-end", nthFromEnd, {4, 8, 10, 12, 14, 16, 18, 20, 22, 24}},
+        {"eps-chain", epsilonChain, {1000, 4000, 16000, 64000, 256000}},
+        {"literal", literal, {1000, 10000, 100000, 1000000}},
+        {"random", randomSparse, {10, 20, 30, 40, 50, 60, 70, 80, 100, 120}},
+    };
+
+    printf("%-13s %8s %9s %9s %9s %11s %11s %10s %11s %11s %8s %10s\n", "family", "n", "nfa", "dfa", "minimal",
+           "closure ms", "subsets ms", "allocs", "minimize ms", "write ms", "text KB", "peak MB");
+    for (const Family& family : families) {
+        if (!only.empty() && only != family.name) continue;
+        for (int n : family.sizes) {
+            int channel[2];
+            if (pipe(channel) != 0) {
+                perror("pipe");
+                return 1;
+            }
+            fflush(stdout);
+            pid_t child = fork();
+            if (child == 0) {
+                close(channel[0]);
+                rlimit limit;
+                limit.rlim_cur = limit.rlim_max = (rlim_t) maxMegabytes << 20;
+                setrlimit(RLIMIT_AS, &limit);
+                CaseResult result = runCase(family, n, threads);
+                ssize_t written = write(channel[1], &result, sizeof(result));
+                _exit(written == (ssize_t) sizeof(result) ? 0 : 1);
+            }
+            close(channel[1]);
+
+            // Wait for the child, killing it at the timeout
+            auto start = std::chrono::steady_clock::now();
+            int status = 0;
+            rusage usage;
+            bool timedOut = false;
+            while (wait4(child, &status, WNOHANG, &usage) == 0) {
+                if (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() > timeout) {
+                    kill(child, SIGKILL);
+                    wait4(child, &status, 0, &usage);
+                    timedOut = true;
+                    break;
+                }
+                usleep(2000);
+            }
+            CaseResult result;
+            bool ok = !timedOut && read(channel[0], &result, sizeof(result)) == (ssize_t) sizeof(result);
+            close(channel[0]);
+            double peakMegabytes = usage.ru_maxrss / 1024.0;
+
+            if (!ok) {
+                printf("%-13s %8d %s after %.1f s (peak %.1f MB)\n", family.name, n,
+                       timedOut ? "timed out" : "failed (memory limit?)",
+                       std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), peakMegabytes);
+                break;
+            }
+            printf("%-13s %8d %9d %9d %9d %11.2f %11.2f %10llu %11.2f %11.2f %8llu %10.1f\n", family.name, n,
+                   result.nfaStates, result.dfaStates, result.minimalStates, result.closureSeconds * 1000,
+                   result.subsetSeconds * 1000, (unsigned long long) result.convertAllocations,
+                   result.minimizeSeconds * 1000, result.writeSeconds * 1000, (unsigned long long) (result.writtenBytes >> 10), peakMegabytes);
+        }
+    }
+    return 0;
+}
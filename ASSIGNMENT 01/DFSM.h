@@ -0,0 +1,314 @@
+// DFSM.h
+#ifndef DFSM_H
+#define DFSM_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+
+// In-memory DFSM with a flat transition table. States are 0-indexed here and
+// 1-indexed in the file format; state 0 is the start state.
+//
+// Besides the three sections the simulators read, a DFSM file may carry an
+// optional fourth section of match IDs, one line per state: "<state> <id> ...".
+// The C simulators stop reading after the accepting states and ignore it.
+//
+// There is also a binary form for caches and fast reloads: the magic
+// "DFSMBIN1", then in native byte order the alphabet size and bytes, the state
+// count, the transition table, one accepting byte per state, and the match ID
+// offsets and IDs (offset count 0 when there are none). readFromFile accepts
+// both forms.
+class DFSM {
+public:
+    std::vector<char> alphabet;
+    int numStates = 0;
+    std::vector<int> transitions;      // numStates * alphabet.size() targets
+    std::vector<char> accepting;       // 1 if the state is accepting
+    std::vector<int> matchOffsets;     // Optional: numStates + 1 offsets into matchIds
+    std::vector<int> matchIds;
+
+    int numSymbols() const { return alphabet.size(); }
+    int next(int state, int symbol) const { return transitions[(size_t) state * alphabet.size() + symbol]; }
+    bool hasMatchIds() const { return !matchOffsets.empty(); }
+
+    // Symbol index by byte value, -1 for bytes outside the alphabet
+    std::vector<int> symbolMap() const {
+        std::vector<int> map(256, -1);
+        for (size_t i = 0; i < alphabet.size(); i++) {
+            map[(unsigned char) alphabet[i]] = i;
+        }
+        return map;
+    }
+
+    int addState() {
+        transitions.resize(transitions.size() + alphabet.size(), 0);
+        accepting.push_back(0);
+        return numStates++;
+    }
+
+    void readFromFile(const std::string& filename) {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Could not open DFSM file: " + filename);
+        }
+
+        char magic[sizeof(binaryMagic) - 1] = {0};
+        file.read(magic, sizeof(magic));
+        if (file.gcount() == (std::streamsize) sizeof(magic) && std::equal(magic, magic + sizeof(magic), binaryMagic)) {
+            readBinary(file, filename);
+            return;
+        }
+        file.clear();
+        file.seekg(0);
+
+        alphabet.clear();
+        transitions.clear();
+        accepting.clear();
+        matchOffsets.clear();
+        matchIds.clear();
+        numStates = 0;
+
+        std::vector<int> acceptingList;
+        std::vector<std::vector<int>> matchLines;
+        std::string line;
+        int section = 0;
+        while (std::getline(file, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty()) {
+                section++;
+                continue;
+            }
+            std::istringstream iss(line);
+            std::string token;
+            if (section == 0) { // Alphabet section
+                while (iss >> token) {
+                    alphabet.push_back(token[0]);
+                }
+            } else if (section == 1) { // Transition table section
+                size_t column = 0;
+                int state;
+                while (iss >> state) {
+                    if (column >= alphabet.size()) {
+                        throw std::runtime_error("More transitions than alphabet symbols in row " + std::to_string(numStates + 1));
+                    }
+                    transitions.push_back(state - 1);
+                    column++;
+                }
+                if (column != alphabet.size()) {
+                    throw std::runtime_error("The number of transitions does not match the number of alphabet symbols in row " + std::to_string(numStates + 1));
+                }
+                numStates++;
+            } else if (section == 2) { // Accepting states section
+                int state;
+                while (iss >> state) {
+                    acceptingList.push_back(state - 1);
+                }
+            } else if (section == 3) { // Match ID section
+                std::vector<int> values;
+                int value;
+                while (iss >> value) {
+                    values.push_back(value);
+                }
+                matchLines.push_back(values);
+            }
+        }
+        file.close();
+
+        if (alphabet.empty() || numStates == 0) {
+            throw std::runtime_error("Necessary sections are empty in " + filename);
+        }
+        for (int target : transitions) {
+            if (target < 0 || target >= numStates) {
+                throw std::runtime_error("Invalid state number " + std::to_string(target + 1) + " in " + filename);
+            }
+        }
+        accepting.assign(numStates, 0);
+        for (int state : acceptingList) {
+            if (state < 0 || state >= numStates) {
+                throw std::runtime_error("Invalid accepting state number " + std::to_string(state + 1));
+            }
+            accepting[state] = 1;
+        }
+        if (!matchLines.empty()) {
+            std::vector<std::vector<int>> ids(numStates);
+            for (const auto& values : matchLines) {
+                if (values.empty() || values[0] < 1 || values[0] > numStates) {
+                    throw std::runtime_error("Invalid state number in match ID section");
+                }
+                ids[values[0] - 1].insert(ids[values[0] - 1].end(), values.begin() + 1, values.end());
+            }
+            setMatchIds(ids);
+        }
+    }
+
+    void writeBinaryFile(const std::string& filename) const {
+        std::ofstream writer(filename, std::ios::binary);
+        if (!writer) {
+            throw std::runtime_error("Could not open output file: " + filename);
+        }
+        writeBinary(writer);
+        writer.close(); // Buffered bytes can still fail to reach the disk here
+        if (!writer) {
+            throw std::runtime_error("Could not write output file: " + filename);
+        }
+    }
+
+    void writeBinary(std::ostream& out) const {
+        out.write(binaryMagic, sizeof(binaryMagic) - 1);
+        writeValue(out, (uint32_t) alphabet.size());
+        out.write(alphabet.data(), alphabet.size());
+        writeValue(out, (uint32_t) numStates);
+        out.write(reinterpret_cast<const char*>(transitions.data()), transitions.size() * sizeof(int));
+        out.write(accepting.data(), accepting.size());
+        writeValue(out, (uint32_t) matchOffsets.size());
+        out.write(reinterpret_cast<const char*>(matchOffsets.data()), matchOffsets.size() * sizeof(int));
+        out.write(reinterpret_cast<const char*>(matchIds.data()), matchIds.size() * sizeof(int));
+    }
+
+    void setMatchIds(const std::vector<std::vector<int>>& ids) {
+        matchOffsets.assign(1, 0);
+        matchIds.clear();
+        for (const auto& list : ids) {
+            matchIds.insert(matchIds.end(), list.begin(), list.end());
+            matchOffsets.push_back(matchIds.size());
+        }
+    }
+
+    void writeToFile(const std::string& filename) const {
+        std::ofstream writer(filename);
+        if (!writer) {
+            throw std::runtime_error("Could not open output file: " + filename);
+        }
+        write(writer);
+    }
+
+    void write(std::ostream& out) const {
+        std::string buffer;
+        for (char symbol : alphabet) {
+            buffer += symbol;
+            buffer += ' ';
+        }
+        buffer += "\n\n";
+
+        for (int state = 0; state < numStates; state++) {
+            for (int symbol = 0; symbol < numSymbols(); symbol++) {
+                buffer += std::to_string(next(state, symbol) + 1);
+                buffer += ' ';
+            }
+            buffer += '\n';
+            if (buffer.size() > (1 << 16)) {
+                out << buffer;
+                buffer.clear();
+            }
+        }
+        buffer += '\n';
+
+        for (int state = 0; state < numStates; state++) {
+            if (accepting[state]) {
+                buffer += std::to_string(state + 1);
+                buffer += ' ';
+            }
+        }
+        buffer += '\n';
+
+        if (hasMatchIds()) {
+            buffer += '\n';
+            for (int state = 0; state < numStates; state++) {
+                if (matchOffsets[state] == matchOffsets[state + 1]) continue;
+                buffer += std::to_string(state + 1);
+                for (int i = matchOffsets[state]; i < matchOffsets[state + 1]; i++) {
+                    buffer += ' ';
+                    buffer += std::to_string(matchIds[i]);
+                }
+                buffer += '\n';
+                if (buffer.size() > (1 << 16)) {
+                    out << buffer;
+                    buffer.clear();
+                }
+            }
+        }
+        out << buffer;
+    }
+
+private:
+    static constexpr char binaryMagic[] = "DFSMBIN1";
+
+    template <typename T>
+    static void writeValue(std::ostream& out, T value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template <typename T>
+    static void readArray(std::istream& in, T* data, size_t count, const std::string& filename) {
+        if (!in.read(reinterpret_cast<char*>(data), count * sizeof(T))) {
+            throw std::runtime_error("Truncated binary DFSM file: " + filename);
+        }
+    }
+
+    // Bytes left in a stream, so that sizes read from a file are checked
+    // against it before anything is allocated for them
+    static uint64_t remainingBytes(std::istream& in) {
+        std::streampos here = in.tellg();
+        in.seekg(0, std::ios::end);
+        std::streampos end = in.tellg();
+        in.seekg(here);
+        return end > here ? (uint64_t) (end - here) : 0;
+    }
+
+    void readBinary(std::istream& in, const std::string& filename) {
+        uint32_t alphabetSize = 0, states = 0, offsets = 0;
+        readArray(in, &alphabetSize, 1, filename);
+        if (alphabetSize > 256 || alphabetSize > remainingBytes(in)) {
+            throw std::runtime_error("Invalid alphabet size in " + filename);
+        }
+        alphabet.resize(alphabetSize);
+        readArray(in, alphabet.data(), alphabetSize, filename);
+        readArray(in, &states, 1, filename);
+        if (states > (uint32_t) INT32_MAX || (uint64_t) states * (alphabetSize * sizeof(int) + 1) > remainingBytes(in)) {
+            throw std::runtime_error("Invalid state count in " + filename);
+        }
+        numStates = states;
+        transitions.resize((size_t) states * alphabetSize);
+        readArray(in, transitions.data(), transitions.size(), filename);
+        accepting.resize(states);
+        readArray(in, accepting.data(), states, filename);
+
+        // Match ID offsets: none, or numStates + 1 of them rising from 0 to
+        // the ID count, which the rest of the file must hold
+        readArray(in, &offsets, 1, filename);
+        if (offsets != 0 && (uint64_t) offsets != (uint64_t) states + 1) {
+            throw std::runtime_error("Invalid match ID section in " + filename);
+        }
+        if ((uint64_t) offsets * sizeof(int) > remainingBytes(in)) {
+            throw std::runtime_error("Truncated binary DFSM file: " + filename);
+        }
+        matchOffsets.resize(offsets);
+        readArray(in, matchOffsets.data(), offsets, filename);
+        for (uint32_t i = 0; i < offsets; i++) {
+            if (i == 0 ? matchOffsets[0] != 0 : matchOffsets[i] < matchOffsets[i - 1]) {
+                throw std::runtime_error("Invalid match ID offsets in " + filename);
+            }
+        }
+        if (offsets && (uint64_t) matchOffsets.back() * sizeof(int) > remainingBytes(in)) {
+            throw std::runtime_error("Truncated binary DFSM file: " + filename);
+        }
+        matchIds.resize(offsets ? matchOffsets.back() : 0);
+        readArray(in, matchIds.data(), matchIds.size(), filename);
+
+        if (alphabet.empty() || numStates == 0) {
+            throw std::runtime_error("Necessary sections are empty in " + filename);
+        }
+        for (int target : transitions) {
+            if (target < 0 || target >= numStates) {
+                throw std::runtime_error("Invalid state number " + std::to_string(target + 1) + " in " + filename);
+            }
+        }
+    }
+};
+
+#endif
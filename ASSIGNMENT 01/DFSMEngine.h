@@ -0,0 +1,261 @@
+// DFSMEngine.h
+#ifndef DFSMENGINE_H
+#define DFSMENGINE_H
+
+#include <string>
+#include <cstdint>
+#include <cctype>
+#include <stdexcept>
+#include <vector>
+#include <algorithm>
+
+#include "DFSM.h"
+#include "CompactTable.h"
+#include "ByteScan.h"
+
+// How a simulator reads its input and which alphabets it accepts. The C
+// simulators (A.c, A1A.c, B.c, A1B1.c, ASSIGNMENT01.c) each hard-code one
+// combination; variant() gives theirs by name.
+struct InputPolicy {
+    enum Blanks {
+        skipBlanks,     // Spaces and newlines are skipped, as in every C simulator
+        skipWhitespace, // Also tabs, carriage returns and form feeds
+        keepBlanks      // Blanks are ordinary input bytes
+    };
+    enum AlphabetRule {
+        anySymbols, // Any byte but blanks
+        letters,    // isalpha, as in A.c, A1A.c, A1B1.c and ASSIGNMENT01.c
+        printable   // isalnum or ispunct, as in B.c
+    };
+
+    Blanks blanks = skipBlanks;
+    bool rejectUnknown = true;   // Otherwise bytes outside the alphabet are skipped
+    bool rejectEmpty = false;    // An input without symbols is an error, as in A1B1.c
+    AlphabetRule alphabet = anySymbols;
+    bool uniqueAlphabet = false; // Repeated alphabet symbols are an error, as in A.c
+
+    static InputPolicy variant(const std::string& name) {
+        InputPolicy policy;
+        if (name == "A") {
+            policy.alphabet = letters;
+            policy.uniqueAlphabet = true;
+        } else if (name == "A1A" || name == "ASSIGNMENT01") {
+            policy.alphabet = letters;
+        } else if (name == "B") {
+            policy.alphabet = printable;
+        } else if (name == "A1B1") {
+            policy.alphabet = letters;
+            policy.rejectEmpty = true;
+        } else if (name != "default") {
+            throw std::runtime_error("Unknown simulator variant '" + name + "' (A, A1A, B, A1B1, ASSIGNMENT01 or default)");
+        }
+        return policy;
+    }
+
+    bool isBlank(unsigned char ch) const {
+        switch (blanks) {
+            case skipBlanks: return ch == ' ' || ch == '\n';
+            case skipWhitespace: return isspace(ch);
+            default: return false;
+        }
+    }
+
+    // Checks the DFSM's alphabet against the rules; the first duplicate wins when they are allowed
+    void validate(const DFSM& dfsm) const {
+        for (size_t i = 0; i < dfsm.alphabet.size(); i++) {
+            unsigned char ch = dfsm.alphabet[i];
+            if ((alphabet == letters && !isalpha(ch)) || (alphabet == printable && !isalnum(ch) && !ispunct(ch))) {
+                throw std::runtime_error(std::string("Alphabet must contain only ") +
+                                         (alphabet == letters ? "alphabetic" : "valid") + " characters");
+            }
+            if (uniqueAlphabet && std::find(dfsm.alphabet.begin(), dfsm.alphabet.begin() + i, (char) ch) != dfsm.alphabet.begin() + i) {
+                throw std::runtime_error(std::string("Duplicate alphabet character ") + (char) ch);
+            }
+        }
+        if (dfsm.alphabet.size() > 256) {
+            throw std::runtime_error("Alphabet has more than 256 symbols");
+        }
+    }
+};
+
+// DFSM runner specialized on the state ID width and on the two input checks.
+// Every byte goes through the table: a skipped byte reads some entry of the
+// current row and a conditional move keeps the current state, so skipping
+// costs no branch. Bytes outside the alphabet are OR-ed into a flag that is
+// tested once per chunk. Instantiations without a check compile it out.
+//
+// States that loop on most symbols, like the start state of a substring
+// machine, are found when the engine is built. In such a state the engine
+// jumps straight to the next byte that can leave it, with memchr when there
+// is only one such byte and with an SSE2 range scan otherwise. Bytes the
+// input policy rejects always count as leaving, so errors are still found.
+template <typename StateId, bool RejectUnknown, bool RejectEmpty>
+class DFSMEngine {
+public:
+    DFSMEngine(const DFSM& dfsm, const InputPolicy& policy, PagePolicy pages, bool skipLoops = true) : rows(dfsm, pages) {
+        for (int b = 0; b < 256; b++) {
+            symbolOf[b] = 0;
+            keep[b] = 0;
+            unknown[b] = !policy.isBlank(b);
+        }
+        for (size_t i = dfsm.alphabet.size(); i-- > 0;) {
+            unsigned char ch = dfsm.alphabet[i];
+            if (policy.isBlank(ch)) continue; // Skipping comes first, as in the C simulators
+            symbolOf[ch] = i;
+            keep[ch] = 1;
+            unknown[ch] = 0;
+        }
+        if (skipLoops) findLoops(dfsm);
+    }
+
+    const CompactTable<StateId>& table() const { return rows; }
+
+    // Number of states the engine skips through
+    int numLoopStates() const { return loops.size(); }
+
+    // Final state after the whole input
+    int run(const char* text, size_t length) const {
+        int current = 0;
+        size_t symbols = 0;
+        if (loops.empty()) {
+            scan<false>(text, 0, length, current, symbols);
+        } else {
+            size_t i = 0;
+            while (i < length) {
+                int slot = loopSlot[current];
+                if (slot < 0) {
+                    i = scan<true>(text, i, length, current, symbols);
+                    continue;
+                }
+                size_t to = skip(loops[slot], text, i, length);
+                if (RejectEmpty && symbols == 0) symbols = hasSymbol(text + i, to - i);
+                // After a short skip the state is likely to come back at once, so the table runs for a while instead
+                size_t stop = std::min(to + (to - i < minSkip ? backOff : 1), length);
+                i = scan<false>(text, to, stop, current, symbols);
+            }
+        }
+        if (RejectEmpty && symbols == 0) {
+            throw std::runtime_error("Input string is empty");
+        }
+        return current;
+    }
+
+private:
+    static const size_t chunk = 4096;
+    static const size_t minSkip = 16;
+    static const size_t backOff = 64;
+
+    // How to leave a state that loops on most bytes
+    struct LoopSkip {
+        enum Kind { toByte, pastRanges, toEnd };
+        Kind kind;
+        unsigned char exit; // toByte: the only byte that leaves the state
+        ByteRanges stays;   // pastRanges: the bytes that keep it
+    };
+
+    CompactTable<StateId> rows;
+    uint8_t symbolOf[256]; // Symbol index of an alphabet byte
+    uint8_t keep[256];     // 1 for alphabet bytes
+    uint8_t unknown[256];  // 1 for bytes that are neither symbols nor skipped
+    std::vector<int> loopSlot; // Index into 'loops' per state, -1 for ordinary states; empty without loop states
+    std::vector<LoopSkip> loops;
+
+    // Runs the table over [from, to); with StopAtLoop it returns early at the first loop state
+    template <bool StopAtLoop>
+    size_t scan(const char* text, size_t from, size_t to, int& current, size_t& symbols) const {
+        for (size_t start = from; start < to; start += chunk) {
+            size_t end = std::min(start + chunk, to);
+            uint8_t bad = 0;
+            for (size_t i = start; i < end; i++) {
+                if (StopAtLoop && loopSlot[current] >= 0) {
+                    if (RejectUnknown && bad) throwUnknown(text + start, i - start);
+                    return i;
+                }
+                unsigned char ch = text[i];
+                int next = rows.next(current, symbolOf[ch]);
+                current = keep[ch] ? next : current;
+                if (RejectEmpty) symbols += keep[ch];
+                if (RejectUnknown) bad |= unknown[ch];
+            }
+            if (RejectUnknown && bad) throwUnknown(text + start, end - start);
+        }
+        return to;
+    }
+
+    // Position of the first byte at or after 'from' that can leave the state
+    static size_t skip(const LoopSkip& loop, const char* text, size_t from, size_t length) {
+        switch (loop.kind) {
+            case LoopSkip::toByte: return findByte(text + from, text + length, loop.exit) - text;
+            case LoopSkip::pastRanges: return findOutside(text + from, text + length, loop.stays) - text;
+            default: return length;
+        }
+    }
+
+    bool hasSymbol(const char* text, size_t length) const {
+        for (size_t i = 0; i < length; i++) {
+            if (keep[(unsigned char) text[i]]) return true;
+        }
+        return false;
+    }
+
+    // A state is worth skipping through when most symbols keep it and the
+    // bytes that leave it are one byte or fit a few ranges
+    void findLoops(const DFSM& dfsm) {
+        std::vector<int> slots(dfsm.numStates, -1);
+        int numSymbols = dfsm.numSymbols();
+        for (int state = 0; state < dfsm.numStates; state++) {
+            int selfLoops = 0;
+            for (int symbol = 0; symbol < numSymbols; symbol++) {
+                selfLoops += dfsm.next(state, symbol) == state;
+            }
+            if (2 * selfLoops <= numSymbols) continue;
+
+            bool stays[256];
+            int exits = 0;
+            LoopSkip loop;
+            for (int b = 0; b < 256; b++) {
+                stays[b] = keep[b] ? rows.next(state, symbolOf[b]) == state : !(RejectUnknown && unknown[b]);
+                if (!stays[b]) {
+                    exits++;
+                    loop.exit = b;
+                }
+            }
+            if (exits == 0) {
+                loop.kind = LoopSkip::toEnd;
+            } else if (exits == 1) {
+                loop.kind = LoopSkip::toByte;
+            } else if (loop.stays.assign(stays)) {
+                loop.kind = LoopSkip::pastRanges;
+            } else {
+                continue;
+            }
+            slots[state] = loops.size();
+            loops.push_back(loop);
+        }
+        if (!loops.empty()) loopSlot.swap(slots);
+    }
+
+    [[noreturn]] void throwUnknown(const char* text, size_t length) const {
+        const char* ch = text;
+        while (ch < text + length - 1 && !unknown[(unsigned char) *ch]) ch++;
+        throw std::runtime_error(std::string("Character '") + *ch + "' is not in the alphabet");
+    }
+};
+
+// Builds the engine matching the DFSM's size and the policy's checks and
+// calls f with it; the choice is made once per run
+template <typename F>
+auto withDFSMEngine(const DFSM& dfsm, const InputPolicy& policy, PagePolicy pages, bool skipLoops, F&& f) {
+    policy.validate(dfsm);
+    return forStateWidth(dfsm.numStates, [&](auto id) {
+        typedef decltype(id) StateId;
+        if (policy.rejectUnknown) {
+            if (policy.rejectEmpty) return f(DFSMEngine<StateId, true, true>(dfsm, policy, pages, skipLoops));
+            return f(DFSMEngine<StateId, true, false>(dfsm, policy, pages, skipLoops));
+        }
+        if (policy.rejectEmpty) return f(DFSMEngine<StateId, false, true>(dfsm, policy, pages, skipLoops));
+        return f(DFSMEngine<StateId, false, false>(dfsm, policy, pages, skipLoops));
+    });
+}
+
+#endif
@@ -0,0 +1,151 @@
+// DFSMEngineTest Program
+// Checks withDFSMEngine against a plain per-byte loop that applies the
+// InputPolicy rules one byte at a time. Random DFSMs, many with states that
+// loop on most symbols, run over random inputs for every simulator variant
+// and for other blank and unknown-byte rules, with loop skipping on and off.
+// The final state or the error message, including which unknown character
+// is reported, must be the same.
+//
+// HOW TO RUN THE CODE:
+// >>g++ -std=c++17 -O2 -o DFSMEngineTest DFSMEngineTest.cpp
+// >>./DFSMEngineTest
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cctype>
+#include <algorithm>
+
+#include "DFSMEngine.h"
+#include "TestCheck.h"
+
+// The input rules written out byte by byte; the final state as a string,
+// or the error message
+static std::string reference(const DFSM& dfsm, const InputPolicy& policy, const std::string& text) {
+    for (size_t i = 0; i < dfsm.alphabet.size(); i++) {
+        unsigned char ch = dfsm.alphabet[i];
+        bool letter = isalpha(ch), valid = isalnum(ch) || ispunct(ch);
+        if (policy.alphabet == InputPolicy::letters && !letter) return "Alphabet must contain only alphabetic characters";
+        if (policy.alphabet == InputPolicy::printable && !valid) return "Alphabet must contain only valid characters";
+        for (size_t j = 0; j < i; j++) {
+            if (policy.uniqueAlphabet && dfsm.alphabet[j] == (char) ch) return std::string("Duplicate alphabet character ") + (char) ch;
+        }
+    }
+
+    int state = 0;
+    size_t symbols = 0;
+    for (char c : text) {
+        unsigned char ch = c;
+        bool blank = policy.blanks == InputPolicy::skipBlanks ? ch == ' ' || ch == '\n' :
+                     policy.blanks == InputPolicy::skipWhitespace ? isspace(ch) != 0 : false;
+        if (blank) continue;
+        auto found = std::find(dfsm.alphabet.begin(), dfsm.alphabet.end(), c);
+        if (found == dfsm.alphabet.end()) {
+            if (policy.rejectUnknown) return std::string("Character '") + c + "' is not in the alphabet";
+            continue;
+        }
+        state = dfsm.next(state, found - dfsm.alphabet.begin());
+        symbols++;
+    }
+    if (policy.rejectEmpty && symbols == 0) return "Input string is empty";
+    return "state " + std::to_string(state);
+}
+
+static std::string engine(const DFSM& dfsm, const InputPolicy& policy, bool skipLoops, const std::string& text) {
+    try {
+        int state = withDFSMEngine(dfsm, policy, smallPages, skipLoops, [&](const auto& engine) {
+            return engine.run(text.data(), text.size());
+        });
+        return "state " + std::to_string(state);
+    } catch (const std::exception& e) {
+        return e.what();
+    }
+}
+
+// Random DFSM over 'alphabet' in which about half of the states keep
+// themselves on all but one to three symbols
+static DFSM randomMachine(std::mt19937& random, const std::string& alphabet, int states) {
+    DFSM dfsm;
+    dfsm.alphabet.assign(alphabet.begin(), alphabet.end());
+    int k = alphabet.size();
+    for (int q = 0; q < states; q++) dfsm.addState();
+    for (int q = 0; q < states; q++) {
+        bool loops = random() % 2;
+        int exits = 1 + random() % 3;
+        for (int s = 0; s < k; s++) {
+            dfsm.transitions[(size_t) q * k + s] = loops && (int) (random() % k) >= exits ? q : random() % states;
+        }
+        dfsm.accepting[q] = random() % 2;
+    }
+    return dfsm;
+}
+
+// Runs of one byte, so loop states get long skips, mixed with random bytes
+static std::string randomInput(std::mt19937& random, const std::string& pool, size_t length) {
+    std::string text;
+    while (text.size() < length) {
+        char c = pool[random() % pool.size()];
+        size_t run = random() % 4 == 0 ? random() % 3000 : 1 + random() % 8;
+        text.append(std::min(run, length - text.size()), c);
+    }
+    return text;
+}
+
+int main() {
+    TestCheck check("DFSMEngineTest");
+    std::mt19937 random(47);
+    const std::vector<std::string> variants = {"default", "A", "A1A", "B", "A1B1", "ASSIGNMENT01"};
+    const std::vector<std::string> alphabets = {
+        "ab", "abcdefghij", "abcdefghijklmnopqrstuvwxyz", "0123456789+-", "abca", "a b", "ab\t", "\x80\xff" "ab"
+    };
+    const std::string others = " \n\t\r\f\v" "xyz9#\x01\x80\xfe";
+
+    for (int round = 0; round < 300; round++) {
+        std::string alphabet = alphabets[random() % alphabets.size()];
+        int states = round % 25 == 0 ? 300 + random() % 200 : 1 + random() % 12;
+        DFSM dfsm = randomMachine(random, alphabet, states);
+
+        std::vector<InputPolicy> policies;
+        for (const std::string& name : variants) policies.push_back(InputPolicy::variant(name));
+        InputPolicy policy;
+        policy.blanks = InputPolicy::skipWhitespace;
+        policies.push_back(policy);
+        policy.blanks = InputPolicy::keepBlanks;
+        policies.push_back(policy);
+        policy.rejectUnknown = false;
+        policies.push_back(policy);
+        policy.blanks = InputPolicy::skipBlanks;
+        policy.rejectEmpty = true;
+        policies.push_back(policy);
+
+        for (int input = 0; input < 4; input++) {
+            std::string pool = alphabet + alphabet + others.substr(0, random() % (others.size() + 1));
+            size_t length = input == 0 ? random() % 3 : random() % (input == 3 ? 20000 : 500);
+            std::string text = randomInput(random, pool, length);
+            std::string name = "round " + std::to_string(round) + ", alphabet \"" + alphabet + "\", input " + std::to_string(input);
+            for (size_t p = 0; p < policies.size(); p++) {
+                std::string expected = reference(dfsm, policies[p], text);
+                std::string what = name + ", policy " + std::to_string(p) + ": expected " + expected;
+                check.expect(engine(dfsm, policies[p], true, text) == expected, what + " with skipping");
+                check.expect(engine(dfsm, policies[p], false, text) == expected, what + " without skipping");
+            }
+        }
+    }
+
+    // The first of several unknown bytes is reported, in any chunk and after a skip
+    DFSM substring;
+    substring.alphabet = {'a', 'b'};
+    for (int q = 0; q < 3; q++) substring.addState();
+    substring.transitions = {0, 1, 0, 2, 2, 2};
+    for (size_t at : {0, 100, 4095, 4096, 4097, 9000}) {
+        std::string text(10000, 'a');
+        text[at] = 'x';
+        text[std::min(at + 1 + random() % 3000, text.size() - 1)] = 'y';
+        for (bool skipLoops : {true, false}) {
+            check.expect(engine(substring, InputPolicy(), skipLoops, text) == "Character 'x' is not in the alphabet",
+                         "unknown byte at " + std::to_string(at) + (skipLoops ? " with skipping" : " without skipping"));
+        }
+    }
+
+    return check.finish();
+}
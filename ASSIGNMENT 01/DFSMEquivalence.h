@@ -0,0 +1,167 @@
+// DFSMEquivalence.h
+#ifndef DFSMEQUIVALENCE_H
+#define DFSMEQUIVALENCE_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <unordered_set>
+
+#include "DFSM.h"
+
+// Decides whether two DFSMs accept the same language.
+//
+// Hopcroft and Karp's algorithm merges the start states of both machines in
+// one union-find forest and walks pairs of states breadth-first; a pair whose
+// states are already in one class is skipped, so at most n1 + n2 - 1 unions
+// happen and the cost is near-linear. The machines are equivalent unless a
+// merged class holds an accepting and a rejecting state.
+//
+// The alphabets may differ. A symbol missing from one machine sends it to an
+// implicit dead state that rejects and loops on every symbol.
+//
+// On a mismatch the distinguishing string is recomputed by a breadth-first
+// walk of the product machine, which yields a shortest one. The product can
+// have n1 * n2 pairs, so the walk may visit at most productPairsPerState pairs
+// per state of the two machines, keeping its memory in proportion to theirs;
+// if it runs out of budget the (possibly longer) string found by the
+// union-find pass is returned instead.
+class DFSMEquivalence {
+public:
+    struct Result {
+        bool equivalent = true;
+        std::string witness;       // Distinguishing string when not equivalent
+        bool acceptedByFirst = false;
+        bool shortest = false;     // Witness is known to be of minimal length
+        size_t pairsVisited = 0;
+    };
+
+    static const size_t productPairsPerState = 8;
+
+    static Result check(const DFSM& first, const DFSM& second) {
+        Machines m(first, second);
+        Result result;
+
+        // Union-find over the states of both machines, dead states included
+        size_t total = m.size(0) + m.size(1);
+        std::vector<int> parent(total);
+        for (size_t i = 0; i < total; i++) parent[i] = i;
+
+        // Pairs remember how they were reached to spell out a witness
+        struct Pair { int p, q, from, symbol; };
+        std::vector<Pair> pairs;
+        pairs.push_back({0, 0, -1, -1});
+        parent[m.size(0)] = 0;
+
+        for (size_t i = 0; i < pairs.size(); i++) {
+            Pair pair = pairs[i];
+            if (m.accepts(0, pair.p) != m.accepts(1, pair.q)) {
+                result.equivalent = false;
+                result.acceptedByFirst = m.accepts(0, pair.p);
+                for (int at = i; pairs[at].from >= 0; at = pairs[at].from) {
+                    result.witness += m.alphabet[pairs[at].symbol];
+                }
+                result.witness.assign(result.witness.rbegin(), result.witness.rend());
+                break;
+            }
+            for (int symbol = 0; symbol < (int) m.alphabet.size(); symbol++) {
+                int p = m.next(0, pair.p, symbol);
+                int q = m.next(1, pair.q, symbol);
+                int rootP = find(parent, p);
+                int rootQ = find(parent, q + m.size(0));
+                if (rootP == rootQ) continue;
+                parent[rootQ] = rootP;
+                pairs.push_back({p, q, (int) i, symbol});
+            }
+        }
+        result.pairsVisited = pairs.size();
+
+        if (!result.equivalent) {
+            shortestWitness(m, result);
+        }
+        return result;
+    }
+
+private:
+    // Both machines over the union alphabet; state size(x) - 1 is machine x's dead state
+    struct Machines {
+        const DFSM* dfsm[2];
+        std::vector<int> localSymbol[2]; // Union symbol to the machine's symbol, -1 if missing
+        std::vector<char> alphabet;
+
+        Machines(const DFSM& first, const DFSM& second) {
+            dfsm[0] = &first;
+            dfsm[1] = &second;
+            std::vector<int> seen(256, -1);
+            for (const DFSM* machine : dfsm) {
+                for (char symbol : machine->alphabet) {
+                    if (seen[(unsigned char) symbol] < 0) {
+                        seen[(unsigned char) symbol] = alphabet.size();
+                        alphabet.push_back(symbol);
+                    }
+                }
+            }
+            for (int x = 0; x < 2; x++) {
+                std::vector<int> map = dfsm[x]->symbolMap();
+                for (char symbol : alphabet) {
+                    localSymbol[x].push_back(map[(unsigned char) symbol]);
+                }
+            }
+        }
+
+        int size(int x) const { return dfsm[x]->numStates + 1; }
+        bool accepts(int x, int state) const { return state < dfsm[x]->numStates && dfsm[x]->accepting[state]; }
+
+        int next(int x, int state, int symbol) const {
+            int dead = dfsm[x]->numStates;
+            int local = localSymbol[x][symbol];
+            if (state == dead || local < 0) return dead;
+            return dfsm[x]->next(state, local);
+        }
+    };
+
+    static int find(std::vector<int>& parent, int x) {
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    }
+
+    // Breadth-first search of the product machine for the nearest disagreeing pair
+    static void shortestWitness(const Machines& m, Result& result) {
+        struct Visit { int from, symbol; };
+        size_t budget = productPairsPerState * (m.size(0) + m.size(1));
+        std::unordered_set<uint64_t> seen;
+        std::vector<std::pair<int, int>> queue;
+        std::vector<Visit> visits;
+        seen.insert(0);
+        queue.emplace_back(0, 0);
+        visits.push_back({-1, -1});
+
+        for (size_t i = 0; i < queue.size(); i++) {
+            int p = queue[i].first, q = queue[i].second;
+            if (m.accepts(0, p) != m.accepts(1, q)) {
+                result.witness.clear();
+                for (int at = i; visits[at].from >= 0; at = visits[at].from) {
+                    result.witness += m.alphabet[visits[at].symbol];
+                }
+                result.witness.assign(result.witness.rbegin(), result.witness.rend());
+                result.acceptedByFirst = m.accepts(0, p);
+                result.shortest = true;
+                return;
+            }
+            if (queue.size() >= budget) return;
+            for (int symbol = 0; symbol < (int) m.alphabet.size(); symbol++) {
+                int nextP = m.next(0, p, symbol);
+                int nextQ = m.next(1, q, symbol);
+                uint64_t key = (uint64_t) nextP << 32 | (uint32_t) nextQ;
+                if (!seen.insert(key).second) continue;
+                queue.emplace_back(nextP, nextQ);
+                visits.push_back({(int) i, symbol});
+            }
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,198 @@
+// DFSMMinimizer.h
+#ifndef DFSMMINIMIZER_H
+#define DFSMMINIMIZER_H
+
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#include "DFSM.h"
+
+// Hopcroft's partition refinement in O(n * |alphabet| * log n).
+//
+// Unreachable states are dropped first. The initial partition separates
+// states by acceptance and, when the DFSM carries match IDs, by their ID
+// lists, so Aho-Corasick machines keep reporting the same patterns. Blocks
+// live in one array of states; a block is a contiguous range of it, and the
+// states marked while processing a splitter are swapped to the front of
+// their block so splitting is just moving a boundary. After a split only the
+// smaller half needs to go on the worklist, unless the block was already
+// waiting there.
+//
+// The result is numbered in breadth-first order from the start state, so
+// equal languages give byte-identical files.
+class DFSMMinimizer {
+public:
+    static DFSM minimize(const DFSM& dfsm) {
+        int k = dfsm.numSymbols();
+
+        // Reachable states, renumbered densely
+        std::vector<int> reachableId(dfsm.numStates, -1), reachable;
+        reachableId[0] = 0;
+        reachable.push_back(0);
+        for (size_t i = 0; i < reachable.size(); i++) {
+            for (int symbol = 0; symbol < k; symbol++) {
+                int target = dfsm.next(reachable[i], symbol);
+                if (reachableId[target] < 0) {
+                    reachableId[target] = reachable.size();
+                    reachable.push_back(target);
+                }
+            }
+        }
+        int n = reachable.size();
+
+        // Predecessors per (symbol, state) in compressed rows
+        std::vector<int> inverseOffsets((size_t) k * n + 1, 0), inverse((size_t) k * n);
+        for (int s = 0; s < n; s++) {
+            for (int symbol = 0; symbol < k; symbol++) {
+                inverseOffsets[(size_t) symbol * n + reachableId[dfsm.next(reachable[s], symbol)] + 1]++;
+            }
+        }
+        for (size_t i = 1; i < inverseOffsets.size(); i++) inverseOffsets[i] += inverseOffsets[i - 1];
+        std::vector<int> fill(inverseOffsets.begin(), inverseOffsets.end() - 1);
+        for (int s = 0; s < n; s++) {
+            for (int symbol = 0; symbol < k; symbol++) {
+                inverse[fill[(size_t) symbol * n + reachableId[dfsm.next(reachable[s], symbol)]]++] = s;
+            }
+        }
+
+        // Initial partition by acceptance and match IDs
+        std::map<std::pair<char, std::vector<int>>, int> classes;
+        std::vector<int> classOf(n);
+        for (int s = 0; s < n; s++) {
+            int original = reachable[s];
+            std::vector<int> ids;
+            if (dfsm.hasMatchIds()) {
+                ids.assign(dfsm.matchIds.begin() + dfsm.matchOffsets[original], dfsm.matchIds.begin() + dfsm.matchOffsets[original + 1]);
+            }
+            auto inserted = classes.emplace(std::make_pair(dfsm.accepting[original], ids), (int) classes.size());
+            classOf[s] = inserted.first->second;
+        }
+
+        Partition partition(n, classOf, classes.size());
+        std::vector<int> worklist;
+        std::vector<char> waiting(n, 0);
+        for (int b = 0; b < partition.numBlocks(); b++) {
+            worklist.push_back(b);
+            waiting[b] = 1;
+        }
+
+        std::vector<int> splitter, touched;
+        while (!worklist.empty()) {
+            int block = worklist.back();
+            worklist.pop_back();
+            waiting[block] = 0;
+            splitter.assign(partition.begin(block), partition.end(block));
+
+            for (int symbol = 0; symbol < k; symbol++) {
+                touched.clear();
+                for (int s : splitter) {
+                    for (int i = inverseOffsets[(size_t) symbol * n + s]; i < inverseOffsets[(size_t) symbol * n + s + 1]; i++) {
+                        int b = partition.mark(inverse[i]);
+                        if (b >= 0) touched.push_back(b);
+                    }
+                }
+                for (int b : touched) {
+                    int fresh = partition.split(b);
+                    if (fresh < 0) continue;
+                    if (waiting[b]) {
+                        worklist.push_back(fresh);
+                        waiting[fresh] = 1;
+                    } else {
+                        int smaller = partition.size(fresh) <= partition.size(b) ? fresh : b;
+                        worklist.push_back(smaller);
+                        waiting[smaller] = 1;
+                    }
+                }
+            }
+        }
+
+        // Number the blocks breadth-first from the start state
+        std::vector<int> blockId(partition.numBlocks(), -1), order;
+        blockId[partition.blockOf(0)] = 0;
+        order.push_back(partition.blockOf(0));
+        DFSM minimal;
+        minimal.alphabet = dfsm.alphabet;
+        std::vector<std::vector<int>> ids;
+        for (size_t i = 0; i < order.size(); i++) {
+            int representative = reachable[*partition.begin(order[i])];
+            minimal.addState();
+            minimal.accepting[i] = dfsm.accepting[representative];
+            for (int symbol = 0; symbol < k; symbol++) {
+                int target = partition.blockOf(reachableId[dfsm.next(representative, symbol)]);
+                if (blockId[target] < 0) {
+                    blockId[target] = order.size();
+                    order.push_back(target);
+                }
+                minimal.transitions[i * k + symbol] = blockId[target];
+            }
+            if (dfsm.hasMatchIds()) {
+                ids.emplace_back(dfsm.matchIds.begin() + dfsm.matchOffsets[representative],
+                                 dfsm.matchIds.begin() + dfsm.matchOffsets[representative + 1]);
+            }
+        }
+        if (dfsm.hasMatchIds()) minimal.setMatchIds(ids);
+        return minimal;
+    }
+
+private:
+    // Blocks are ranges [first, end) of 'elements'; the first 'marked' states
+    // of a block are those marked by the current splitter
+    class Partition {
+    public:
+        Partition(int n, const std::vector<int>& classOf, int numClasses)
+            : elements(n), location(n), block(n), blockFirst(numClasses + 1, 0), blockEnd(numClasses), marked(numClasses, 0) {
+            for (int s = 0; s < n; s++) blockFirst[classOf[s] + 1]++;
+            for (int c = 0; c < numClasses; c++) blockFirst[c + 1] += blockFirst[c];
+            for (int c = 0; c < numClasses; c++) blockEnd[c] = blockFirst[c];
+            for (int s = 0; s < n; s++) {
+                int c = classOf[s];
+                location[s] = blockEnd[c]++;
+                elements[location[s]] = s;
+                block[s] = c;
+            }
+            blockFirst.pop_back();
+        }
+
+        int numBlocks() const { return blockFirst.size(); }
+        int blockOf(int state) const { return block[state]; }
+        int size(int b) const { return blockEnd[b] - blockFirst[b]; }
+        const int* begin(int b) const { return elements.data() + blockFirst[b]; }
+        const int* end(int b) const { return elements.data() + blockEnd[b]; }
+
+        // Marks a state; returns its block if it is the first mark there, else -1
+        int mark(int state) {
+            int b = block[state];
+            int position = location[state];
+            int boundary = blockFirst[b] + marked[b];
+            if (position < boundary) return -1;
+            std::swap(elements[position], elements[boundary]);
+            location[elements[position]] = position;
+            location[state] = boundary;
+            marked[b]++;
+            return marked[b] == 1 ? b : -1;
+        }
+
+        // Splits the marked states off into a new block; returns it, or -1 if all were marked
+        int split(int b) {
+            int count = marked[b];
+            marked[b] = 0;
+            if (count == size(b)) return -1;
+            int fresh = blockFirst.size();
+            blockFirst.push_back(blockFirst[b]);
+            blockEnd.push_back(blockFirst[b] + count);
+            marked.push_back(0);
+            blockFirst[b] += count;
+            for (int i = blockFirst[fresh]; i < blockEnd[fresh]; i++) {
+                block[elements[i]] = fresh;
+            }
+            return fresh;
+        }
+
+    private:
+        std::vector<int> elements, location, block;
+        std::vector<int> blockFirst, blockEnd, marked;
+    };
+};
+
+#endif
@@ -0,0 +1,180 @@
+// DFSMThroughput Program
+// Multi-threaded DFSM runner for measuring table placement. Every thread runs
+// the DFSM over the whole input the given number of times and the program
+// reports the combined throughput and, where the hardware counters can be
+// read, the data-TLB load misses per KB of input. The table uses 8-, 16- or
+// 32-bit state numbers, whichever is the smallest that fits.
+//
+// --pages places the transition table in small, transparent huge (thp) or
+// explicit huge pages. Threads are spread round-robin over the NUMA nodes and
+// pinned there; with --replicate every node gets its own copy of the table,
+// built by a thread on that node so that its pages are local.
+//
+// HOW TO RUN THE CODE:
+// >>g++ -std=c++17 -O2 -pthread -o DFSMThroughput DFSMThroughput.cpp
+// >>./DFSMThroughput [-j <threads>] [--pages small|thp|huge] [--replicate] [--repeat <count>] [--stats] DFSM.txt INPUT.txt
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <cstdlib>
+
+#include "DFSM.h"
+#include "CompactTable.h"
+#include "MappedFile.h"
+#include "Stats.h"
+
+struct ThreadResult {
+    int finalState = 0;
+    uint64_t tlbMisses = 0;
+    bool counted = false;
+};
+
+struct RunTimes {
+    double placeSeconds = 0, placeCpuSeconds = 0;
+    double seconds = 0, cpuSeconds = 0;
+    PagePolicy policy = smallPages;
+    size_t hugeBackedBytes = 0;
+};
+
+int main(int argc, char* argv[]) {
+    bool wantStats = Stats::takeFlag(argc, argv);
+    Stats stats("DFSMThroughput");
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    PagePolicy pages = transparentHugePages;
+    bool replicate = false;
+    int repeat = 1;
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; arg++) {
+        std::string option = argv[arg];
+        if (option == "-j" && arg + 1 < argc) {
+            threads = std::max(1, atoi(argv[++arg]));
+        } else if (option == "--pages" && arg + 1 < argc) {
+            try {
+                pages = parsePagePolicy(argv[++arg]);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+                return 1;
+            }
+        } else if (option == "--replicate") {
+            replicate = true;
+        } else if (option == "--repeat" && arg + 1 < argc) {
+            repeat = std::max(1, atoi(argv[++arg]));
+        } else {
+            arg = argc;
+        }
+    }
+    if (argc - arg != 2) {
+        std::cerr << "Usage: " << argv[0] << " [-j <threads>] [--pages small|thp|huge] [--replicate] [--repeat <count>] [--stats] <DFSM file> <input string file>" << std::endl;
+        return 1;
+    }
+
+    try {
+        DFSM dfsm;
+        dfsm.readFromFile(argv[arg]);
+        MappedFile input(argv[arg + 1]);
+        std::vector<int> symbolMap = dfsm.symbolMap();
+        for (size_t i = 0; i < input.size(); i++) {
+            char ch = input.data()[i];
+            if (ch != '\n' && ch != ' ' && symbolMap[(unsigned char) ch] < 0) {
+                throw std::runtime_error(std::string("Character '") + ch + "' is not in the alphabet");
+            }
+        }
+
+        NumaTopology topology;
+        int numTables = replicate ? topology.numNodes() : 1;
+        std::vector<ThreadResult> results(threads);
+        RunTimes times = forStateWidth(dfsm.numStates, [&](auto id) {
+            typedef CompactTable<decltype(id)> Table;
+            RunTimes times;
+
+            // One table per node when replicating, each written from a thread pinned to its node
+            std::vector<std::unique_ptr<Table>> tables(numTables);
+            auto placeStart = std::chrono::steady_clock::now();
+            double placeCpuStart = Stats::cpuSeconds();
+            std::vector<std::thread> placers;
+            for (int node = 0; node < numTables; node++) {
+                placers.emplace_back([&, node]() {
+                    if (replicate) topology.pinToNode(node);
+                    tables[node].reset(new Table(dfsm, pages));
+                });
+            }
+            for (auto& thread : placers) thread.join();
+            times.placeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - placeStart).count();
+            times.placeCpuSeconds = Stats::cpuSeconds() - placeCpuStart;
+            times.policy = tables[0]->policy();
+            times.hugeBackedBytes = tables[0]->hugeBackedBytes();
+
+            auto start = std::chrono::steady_clock::now();
+            double cpuStart = Stats::cpuSeconds();
+            std::vector<std::thread> pool;
+            for (int t = 0; t < threads; t++) {
+                pool.emplace_back([&, t]() {
+                    int node = t % topology.numNodes();
+                    topology.pinToNode(node);
+                    const Table& table = *tables[replicate ? node : 0];
+                    TLBMissCounter counter;
+                    counter.start();
+                    int current = 0;
+                    for (int r = 0; r < repeat; r++) {
+                        current = 0;
+                        const char* text = input.data();
+                        for (size_t i = 0; i < input.size(); i++) {
+                            char ch = text[i];
+                            if (ch == '\n' || ch == ' ') continue;
+                            current = table.next(current, symbolMap[(unsigned char) ch]);
+                        }
+                    }
+                    results[t].tlbMisses = counter.stop();
+                    results[t].counted = counter.available();
+                    results[t].finalState = current;
+                });
+            }
+            for (auto& thread : pool) thread.join();
+            times.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            times.cpuSeconds = Stats::cpuSeconds() - cpuStart;
+            return times;
+        });
+
+        double scanned = (double) input.size() * repeat * threads;
+        uint64_t tlbMisses = 0;
+        bool counted = true;
+        for (const ThreadResult& result : results) {
+            tlbMisses += result.tlbMisses;
+            counted = counted && result.counted;
+        }
+        size_t tableBytes = dfsm.transitions.size() * stateIdBytes(dfsm.numStates);
+        std::cout << (dfsm.accepting[results[0].finalState] ? "yes" : "no") << std::endl;
+        std::cerr << "table: " << tableBytes << " bytes (" << stateIdBytes(dfsm.numStates) << "-byte state IDs) in "
+                  << pagePolicyName(times.policy) << " pages, " << times.hugeBackedBytes << " bytes huge-backed, "
+                  << numTables << " cop" << (numTables == 1 ? "y" : "ies") << " for " << topology.numNodes()
+                  << " NUMA node" << (topology.numNodes() == 1 ? "" : "s") << " (placed in " << times.placeSeconds * 1000 << " ms)\n"
+                  << "threads: " << threads << ", scanned " << scanned / (1 << 20) << " MB in " << times.seconds << " s: "
+                  << scanned / (1 << 20) / times.seconds << " MB/s" << std::endl;
+        if (counted) {
+            std::cerr << "dTLB load misses: " << tlbMisses << " (" << tlbMisses / (scanned / 1024) << " per KB)" << std::endl;
+        } else {
+            std::cerr << "dTLB load misses: counter not available" << std::endl;
+        }
+
+        if (wantStats) {
+            stats.addStage("place_table", times.placeSeconds, times.placeCpuSeconds, 0);
+            stats.addStage("simulate", times.seconds, times.cpuSeconds, (uint64_t) scanned);
+            stats.set("threads", threads);
+            stats.set("numa_nodes", topology.numNodes());
+            stats.set("table_copies", numTables);
+            stats.set("state_id_bytes", stateIdBytes(dfsm.numStates));
+            stats.set("table_bytes", tableBytes);
+            stats.set("huge_backed_bytes", times.hugeBackedBytes);
+            if (counted) stats.set("dtlb_load_misses", tlbMisses);
+            stats.report();
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
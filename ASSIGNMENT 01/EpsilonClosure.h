@@ -0,0 +1,163 @@
+// EpsilonClosure.h
+#ifndef EPSILONCLOSURE_H
+#define EPSILONCLOSURE_H
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include "NDFSM.h"
+
+// Epsilon closures of every NDFSM state, computed once as bit rows.
+//
+// Epsilon cycles are collapsed into strongly connected components, which
+// share one row. Tarjan's algorithm emits a component only after every
+// component it reaches, so each row is built by OR-ing the finished rows of
+// its successors word by word. A row only stores the words between its
+// lowest and highest member, and states without epsilon moves get no row at
+// all since their closure is just themselves.
+class EpsilonClosure {
+public:
+    explicit EpsilonClosure(const NDFSM& ndfsm) : rowOf(ndfsm.numStates(), -1) {
+        int n = ndfsm.numStates();
+
+        // Iterative Tarjan over the epsilon edges
+        std::vector<int> index(n, -1), lowLink(n, 0);
+        std::vector<int> stack, callStack;
+        std::vector<size_t> nextEdge(n, 0);
+        std::vector<char> onStack(n, 0);
+
+        int counter = 0;
+        std::vector<int> members;
+        for (int root = 0; root < n; root++) {
+            if (index[root] >= 0 || ndfsm.epsilonTargets(root).empty()) continue;
+            callStack.push_back(root);
+            while (!callStack.empty()) {
+                int s = callStack.back();
+                if (index[s] < 0) {
+                    index[s] = lowLink[s] = counter++;
+                    stack.push_back(s);
+                    onStack[s] = 1;
+                }
+                NDFSM::Targets edges = ndfsm.epsilonTargets(s);
+                if (nextEdge[s] < edges.size()) {
+                    int t = edges.begin()[nextEdge[s]++];
+                    if (index[t] < 0) {
+                        callStack.push_back(t);
+                    } else if (onStack[t]) {
+                        lowLink[s] = std::min(lowLink[s], index[t]);
+                    }
+                    continue;
+                }
+                callStack.pop_back();
+                if (!callStack.empty()) {
+                    int parent = callStack.back();
+                    lowLink[parent] = std::min(lowLink[parent], lowLink[s]);
+                }
+                if (lowLink[s] == index[s]) {
+                    members.clear();
+                    int t;
+                    do {
+                        t = stack.back();
+                        stack.pop_back();
+                        onStack[t] = 0;
+                        members.push_back(t);
+                    } while (t != s);
+                    addComponent(members, ndfsm);
+                }
+            }
+        }
+    }
+
+    // True if the state's closure is more than the state itself
+    bool hasRow(int state) const { return rowOf[state] >= 0; }
+
+    // ORs the closure of 'state' into 'bits', widening [lo, hi] to the words touched
+    void orInto(int state, uint64_t* bits, size_t& lo, size_t& hi) const {
+        int row = rowOf[state];
+        size_t first = row < 0 ? (size_t) state >> 6 : rowFirstWord[row];
+        size_t last = row < 0 ? first : first + rowOffset[row + 1] - rowOffset[row] - 1;
+        orWords(state, bits, 0);
+        lo = std::min(lo, first);
+        hi = std::max(hi, last);
+    }
+
+    // Closure of a single state as a sorted vector
+    std::vector<int> closureOf(int state) const {
+        std::vector<int> closure;
+        int row = rowOf[state];
+        if (row < 0) {
+            closure.push_back(state);
+            return closure;
+        }
+        for (size_t i = rowOffset[row]; i < rowOffset[row + 1]; i++) {
+            uint64_t word = words[i];
+            size_t base = (rowFirstWord[row] + i - rowOffset[row]) * 64;
+            while (word) {
+                closure.push_back(base + __builtin_ctzll(word));
+                word &= word - 1;
+            }
+        }
+        return closure;
+    }
+
+    int numRows() const { return rowFirstWord.size(); }
+    size_t rowWords() const { return words.size(); }
+
+private:
+    std::vector<int> rowOf;              // Row of each state, -1 if the closure is the state alone
+    std::vector<size_t> rowFirstWord;    // First bitset word each row covers
+    std::vector<size_t> rowOffset{0};    // Start of each row in 'words'
+    std::vector<uint64_t> words;
+
+    // ORs the closure of 'state' into a bitset whose first word is word 'base'
+    void orWords(int state, uint64_t* bits, size_t base) const {
+        int row = rowOf[state];
+        if (row < 0) {
+            bits[(state >> 6) - base] |= 1ULL << (state & 63);
+            return;
+        }
+        const uint64_t* source = &words[rowOffset[row]];
+        uint64_t* target = bits + (rowFirstWord[row] - base);
+        size_t count = rowOffset[row + 1] - rowOffset[row];
+        for (size_t i = 0; i < count; i++) {
+            target[i] |= source[i];
+        }
+    }
+
+    void addComponent(const std::vector<int>& members, const NDFSM& ndfsm) {
+        if (members.size() == 1 && ndfsm.epsilonTargets(members[0]).empty()) return;
+
+        // Members have no row yet, so they count as single bits here
+        size_t lo = SIZE_MAX, hi = 0;
+        for (int s : members) {
+            lo = std::min(lo, (size_t) s >> 6);
+            hi = std::max(hi, (size_t) s >> 6);
+            for (int t : ndfsm.epsilonTargets(s)) {
+                int row = rowOf[t];
+                size_t first = row < 0 ? (size_t) t >> 6 : rowFirstWord[row];
+                size_t last = row < 0 ? first : first + rowOffset[row + 1] - rowOffset[row] - 1;
+                lo = std::min(lo, first);
+                hi = std::max(hi, last);
+            }
+        }
+
+        int row = rowFirstWord.size();
+        rowFirstWord.push_back(lo);
+        words.resize(words.size() + (hi - lo + 1), 0);
+        rowOffset.push_back(words.size());
+
+        uint64_t* bits = &words[rowOffset[row]];
+        for (int s : members) {
+            bits[(s >> 6) - lo] |= 1ULL << (s & 63);
+            for (int t : ndfsm.epsilonTargets(s)) {
+                orWords(t, bits, lo);
+            }
+        }
+        for (int s : members) {
+            rowOf[s] = row;
+        }
+    }
+};
+
+#endif
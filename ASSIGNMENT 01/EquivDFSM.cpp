@@ -0,0 +1,55 @@
+// EquivDFSM Program
+// Decides whether two DFSM files accept the same language and, if not,
+// prints a shortest string on which they disagree. The exit status is 0 for
+// equivalent machines, 2 for different ones and 1 on errors.
+//
+// HOW TO RUN THE CODE:
+// >>g++ -std=c++17 -O2 -o EquivDFSM EquivDFSM.cpp
+// >>./EquivDFSM [--stats] DFSM.txt MINIMAL.txt
+
+#include <iostream>
+#include <string>
+
+#include "DFSM.h"
+#include "DFSMEquivalence.h"
+#include "Stats.h"
+
+int main(int argc, char* argv[]) {
+    bool wantStats = Stats::takeFlag(argc, argv);
+    Stats stats("EquivDFSM");
+    Stats* statsOut = wantStats ? &stats : nullptr;
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " [--stats] <first DFSM file> <second DFSM file>" << std::endl;
+        return 1;
+    }
+
+    DFSM first, second;
+    try {
+        Stats::Stage read(statsOut, "read_dfsm");
+        read.addBytes(Stats::fileBytes(argv[1]) + Stats::fileBytes(argv[2]));
+        first.readFromFile(argv[1]);
+        second.readFromFile(argv[2]);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    Stats::Stage check(statsOut, "check");
+    DFSMEquivalence::Result result = DFSMEquivalence::check(first, second);
+    check.stop();
+    if (wantStats) {
+        stats.set("dfa_states", first.numStates + second.numStates);
+        stats.set("pairs_visited", result.pairsVisited);
+        stats.set("equivalent", result.equivalent);
+    }
+    if (result.equivalent) {
+        std::cout << "equivalent (" << result.pairsVisited << " state pairs)" << std::endl;
+        if (wantStats) stats.report();
+        return 0;
+    }
+    std::cout << "not equivalent: \"" << result.witness << "\" is accepted by "
+              << (result.acceptedByFirst ? argv[1] : argv[2]) << " only"
+              << (result.shortest ? "" : " (may not be the shortest such string)") << std::endl;
+    if (wantStats) stats.report();
+    return 2;
+}
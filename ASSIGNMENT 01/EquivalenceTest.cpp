@@ -0,0 +1,141 @@
+// EquivalenceTest Program
+// Checks DFSMEquivalence::check against a plain breadth-first walk of the
+// product machine: the verdict must agree, a witness must be accepted by
+// exactly one of the machines and be as short as possible when the result
+// says so, and renumbered, padded and minimized copies must be equivalent.
+//
+// HOW TO RUN THE CODE:
+// >>g++ -std=c++17 -O2 -o EquivalenceTest EquivalenceTest.cpp
+// >>./EquivalenceTest
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#include "DFSMEquivalence.h"
+#include "DFSMMinimizer.h"
+#include "TestMachines.h"
+#include "TestCheck.h"
+
+// Length of the shortest string accepted by exactly one machine, -1 if
+// there is none. A symbol missing from a machine sends it to a dead state.
+static int shortestDifference(const DFSM& first, const DFSM& second) {
+    std::vector<char> alphabet = first.alphabet;
+    for (char symbol : second.alphabet) {
+        if (std::find(alphabet.begin(), alphabet.end(), symbol) == alphabet.end()) alphabet.push_back(symbol);
+    }
+    std::vector<int> map[2] = {first.symbolMap(), second.symbolMap()};
+    const DFSM* dfsm[2] = {&first, &second};
+    auto step = [&](int x, int state, char symbol) {
+        int local = map[x][(unsigned char) symbol];
+        return state < 0 || local < 0 ? -1 : dfsm[x]->next(state, local);
+    };
+    auto accepts = [&](int x, int state) { return state >= 0 && dfsm[x]->accepting[state]; };
+
+    std::map<std::pair<int, int>, int> depth;
+    std::vector<std::pair<int, int>> queue(1, {0, 0});
+    depth[queue[0]] = 0;
+    for (size_t i = 0; i < queue.size(); i++) {
+        int p = queue[i].first, q = queue[i].second;
+        if (accepts(0, p) != accepts(1, q)) return depth[queue[i]];
+        for (char symbol : alphabet) {
+            std::pair<int, int> next(step(0, p, symbol), step(1, q, symbol));
+            if (depth.emplace(next, depth[queue[i]] + 1).second) queue.push_back(next);
+        }
+    }
+    return -1;
+}
+
+// Copy with the states other than the start renumbered at random and
+// 'extra' unreachable states appended
+static DFSM shuffled(const DFSM& dfsm, int extra, std::mt19937& random) {
+    int n = dfsm.numStates, k = dfsm.numSymbols();
+    std::vector<int> order(n + extra);
+    for (int q = 0; q < n + extra; q++) order[q] = q;
+    std::shuffle(order.begin() + 1, order.end(), random);
+    DFSM copy;
+    copy.alphabet = dfsm.alphabet;
+    for (int q = 0; q < n + extra; q++) copy.addState();
+    for (int q = 0; q < n + extra; q++) {
+        for (int s = 0; s < k; s++) {
+            int target = q < n ? dfsm.next(q, s) : random() % (n + extra);
+            copy.transitions[(size_t) order[q] * k + s] = order[target];
+        }
+        copy.accepting[order[q]] = q < n ? dfsm.accepting[q] : random() % 2;
+    }
+    return copy;
+}
+
+// Checks one pair against the product walk
+static void compare(TestCheck& check, const DFSM& first, const DFSM& second, const std::string& name) {
+    DFSMEquivalence::Result result = DFSMEquivalence::check(first, second);
+    int shortest = shortestDifference(first, second);
+    if (!check.expect(result.equivalent == (shortest < 0), name + ": verdict")) return;
+    if (result.equivalent) return;
+
+    bool byFirst = TestMachines::accepts(first, result.witness);
+    bool bySecond = TestMachines::accepts(second, result.witness);
+    check.expect(byFirst != bySecond, name + ": witness \"" + result.witness + "\" is accepted by exactly one machine");
+    check.expect(result.acceptedByFirst == byFirst, name + ": acceptedByFirst");
+    if (result.shortest) {
+        check.expect((int) result.witness.size() == shortest, name + ": witness has length " +
+                     std::to_string(result.witness.size()) + ", the shortest has " + std::to_string(shortest));
+    } else {
+        check.expect((int) result.witness.size() >= shortest, name + ": witness is no shorter than the shortest");
+    }
+}
+
+int main() {
+    TestCheck check("EquivalenceTest");
+    std::mt19937 random(36);
+
+    // Small random pairs, often over different alphabets, so that both
+    // verdicts come up
+    for (int round = 0; round < 2000; round++) {
+        DFSM first = TestMachines::randomDFSM(random, 1 + random() % 6, 1 + random() % 3);
+        DFSM second = TestMachines::randomDFSM(random, 1 + random() % 6, 1 + random() % 3);
+        compare(check, first, second, "random pair " + std::to_string(round));
+    }
+
+    for (int round = 0; round < 300; round++) {
+        int symbols = 1 + random() % 3;
+        DFSM dfsm = TestMachines::randomDFSM(random, 1 + random() % 40, symbols);
+        std::string name = "round " + std::to_string(round);
+
+        DFSM copy = shuffled(dfsm, random() % 5, random);
+        check.expect(DFSMEquivalence::check(dfsm, copy).equivalent, name + ": renumbered copy with unreachable states");
+        check.expect(DFSMEquivalence::check(dfsm, DFSMMinimizer::minimize(dfsm)).equivalent,
+                     name + ": minimized copy");
+
+        // One flipped state is a difference exactly when it is reachable
+        DFSM flipped = copy;
+        int state = random() % flipped.numStates;
+        flipped.accepting[state] = !flipped.accepting[state];
+        compare(check, dfsm, flipped, name + ": flipped state");
+        compare(check, flipped, dfsm, name + ": flipped state, swapped");
+
+        // A new symbol leading to a rejecting sink changes nothing; leading
+        // to an accepting state it must show up in the witness
+        DFSM wider;
+        wider.alphabet = dfsm.alphabet;
+        wider.alphabet.push_back('a' + symbols);
+        for (int q = 0; q <= dfsm.numStates; q++) wider.addState();
+        int sink = dfsm.numStates;
+        for (int q = 0; q <= dfsm.numStates; q++) {
+            for (int s = 0; s <= symbols; s++) {
+                int target = q == sink || s == symbols ? sink : dfsm.next(q, s);
+                wider.transitions[(size_t) q * (symbols + 1) + s] = target;
+            }
+            wider.accepting[q] = q < sink && dfsm.accepting[q];
+        }
+        check.expect(DFSMEquivalence::check(dfsm, wider).equivalent, name + ": extra symbol into a rejecting sink");
+        wider.accepting[sink] = true;
+        compare(check, dfsm, wider, name + ": extra symbol into an accepting sink");
+        DFSMEquivalence::Result result = DFSMEquivalence::check(dfsm, wider);
+        check.expect(result.witness.find('a' + symbols) != std::string::npos, name + ": witness uses the extra symbol");
+    }
+
+    return check.finish();
+}
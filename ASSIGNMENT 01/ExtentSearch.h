@@ -0,0 +1,335 @@
+// ExtentSearch.h
+#ifndef EXTENTSEARCH_H
+#define EXTENTSEARCH_H
+
+#include <vector>
+#include <set>
+#include <string>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+
+#include "NDFSM.h"
+#include "DFSM.h"
+#include "NDFSMtoDFSM.h"
+#include "DFSMMinimizer.h"
+#include "ReverseFSM.h"
+#include "LiteralFactor.h"
+#include "ByteScan.h"
+#include "CompactTable.h"
+
+// Finds the exact extents of the matches of a machine's language in a text:
+// non-overlapping, left to right, each starting at the leftmost position
+// where any match starts and extending as far as possible from there
+// (leftmost-longest). Empty matches are not reported.
+//
+// Two automata do the work. The forward DFSM is the minimal DFSM of the
+// language. The reverse DFSM is built from it by subset construction and reads
+// the text backwards: its state at position i is the set of forward states
+// from which some text[i..e) leads to acceptance. One backward pass records
+// that state at every position, and a start is a position where the forward
+// start state is in the set. From each leftmost start the forward DFSM then
+// runs only while its state is still in the set one position ahead, which
+// stops it right after the longest match instead of where it dies. Each byte
+// is read once backwards and at most once forwards outside the matches, so a
+// search is linear in the text. Bytes outside the alphabet cannot be part of
+// a match.
+//
+// When every match must contain some literal, the prefilter looks for the
+// literal first and the two passes only run over windows around its
+// occurrences. A window reaches as far back and forward from an occurrence
+// as two more DFSMs, for what may precede and what may follow the literal
+// in a match, stay alive, so every match lies inside one window and the
+// results are those of a full scan. When the literal is so frequent that the
+// windows would cost more than the text, the search scans the whole text.
+class ExtentSearch {
+public:
+    // What the prefilter did in one find()
+    struct PrefilterCounts {
+        size_t candidates = 0;  // Occurrences of the literal
+        size_t windows = 0;     // Merged windows the passes ran over
+        size_t windowBytes = 0;
+        bool fullScan = false;  // Windows abandoned for a scan of the whole text
+    };
+
+    explicit ExtentSearch(const NDFSM& ndfsm, bool prefilter = true)
+        : forwardDFSM(DFSMMinimizer::minimize(NDFSMtoDFSM::convertToDFSM(ndfsm))) {
+        prepare(prefilter);
+    }
+
+    explicit ExtentSearch(const DFSM& dfsm, bool prefilter = true)
+        : forwardDFSM(DFSMMinimizer::minimize(dfsm)) {
+        prepare(prefilter);
+    }
+
+    const DFSM& forward() const { return forwardDFSM; }
+    const DFSM& reverse() const { return reverseDFSM; }
+
+    // Literal every match contains, "" when the prefilter is off or there is none
+    const std::string& factor() const { return literal; }
+
+    // Calls report(start, end) for every match, 'end' exclusive; returns the match count
+    template <typename F>
+    size_t find(const char* text, size_t length, F&& report, PrefilterCounts* counts = nullptr) const {
+        PrefilterCounts ignored;
+        if (!counts) counts = &ignored;
+        if (literal.empty()) return findBetween(text, 0, length, report);
+
+        // Windows around the literal's occurrences, merged as they overlap; the
+        // scans that size them may read at most about twice the text
+        std::vector<std::pair<size_t, size_t>> windows;
+        size_t work = 0, budget = 2 * length + 4096;
+        const char* end = text + length;
+        for (const char* hit = findLiteral(text, end, literal); hit < end; hit = findLiteral(hit + 1, end, literal)) {
+            counts->candidates++;
+            size_t first, last;
+            bool possible = window(text, length, hit - text, first, last, work);
+            if (work > budget) {
+                counts->fullScan = true;
+                return findBetween(text, 0, length, report);
+            }
+            if (!possible) continue;
+            while (!windows.empty() && first < windows.back().second) {
+                first = std::min(first, windows.back().first);
+                last = std::max(last, windows.back().second);
+                windows.pop_back();
+            }
+            windows.push_back({first, last});
+        }
+
+        size_t matches = 0;
+        for (const auto& range : windows) {
+            counts->windows++;
+            counts->windowBytes += range.second - range.first;
+            matches += findBetween(text, range.first, range.second, report);
+        }
+        return matches;
+    }
+
+private:
+    DFSM forwardDFSM;
+    DFSM reverseDFSM;
+    std::vector<uint64_t> members; // Forward states in each reverse state, one bit row per state
+    size_t memberWords = 0;
+    std::vector<char> startsBefore; // By reverse state and symbol: a match starts at that symbol
+    std::vector<int> symbolMap;
+    std::vector<char> dead; // Forward states from which no accepting state is reachable
+
+    std::string literal;
+    DFSM beforeDFSM; // Reversed words that can precede the literal in a match
+    DFSM afterDFSM;  // Words that can follow it
+    std::vector<char> beforeDead, afterDead;
+
+    bool contains(int reverseState, int forwardState) const {
+        return members[reverseState * memberWords + forwardState / 64] >> (forwardState % 64) & 1;
+    }
+
+    // The two passes over text[from, to), which must contain every match it overlaps
+    template <typename F>
+    size_t findBetween(const char* text, size_t from, size_t to, F&& report) const {
+        return forStateWidth(reverseDFSM.numStates, [&](auto width) {
+            return scan<decltype(width)>(text, from, to, report);
+        });
+    }
+
+    template <typename StateId, typename F>
+    size_t scan(const char* text, size_t from, size_t to, F& report) const {
+        // Backward pass: reached[i - from] is the reverse state after reading
+        // text[i..to), and i is a start when the forward DFSM's first step
+        // from text[i] lands in the set one position ahead
+        std::vector<StateId> reached(to - from + 1);
+        std::vector<uint64_t> starts((to - from) / 64 + 1, 0);
+        size_t numSymbols = reverseDFSM.alphabet.size();
+        int state = 0;
+        reached[to - from] = 0;
+        for (size_t i = to; i-- > from;) {
+            int symbol = symbolMap[(unsigned char) text[i]];
+            if (symbol >= 0 && startsBefore[(size_t) state * numSymbols + symbol]) {
+                starts[(i - from) / 64] |= 1ULL << ((i - from) % 64);
+            }
+            state = symbol < 0 ? 0 : reverseDFSM.next(state, symbol);
+            reached[i - from] = state;
+        }
+
+        size_t matches = 0;
+        size_t position = from;
+        for (;;) {
+            size_t start = from + nextStart(starts, position - from, to - from);
+            if (start >= to) break;
+
+            // Forward pass from the start while an accepting state is still
+            // ahead; the longest match ends at the last accepting state
+            size_t end = start;
+            state = 0;
+            for (size_t i = start; i < to; i++) {
+                int symbol = symbolMap[(unsigned char) text[i]];
+                if (symbol < 0) break;
+                int next = forwardDFSM.next(state, symbol);
+                if (!contains(reached[i + 1 - from], next)) break;
+                state = next;
+                if (forwardDFSM.accepting[state]) end = i + 1;
+            }
+            if (end > start) {
+                report(start, end);
+                matches++;
+                position = end;
+            } else {
+                position = start + 1;
+            }
+        }
+        return matches;
+    }
+
+    // Smallest range [first, last) holding every match that uses the occurrence
+    // of the literal at 'at'; false when no match can use it
+    bool window(const char* text, size_t length, size_t at, size_t& first, size_t& last, size_t& work) const {
+        const size_t none = (size_t) -1;
+        first = beforeDFSM.accepting[0] ? at : none;
+        int state = 0;
+        for (size_t i = at; i-- > 0;) {
+            int symbol = symbolMap[(unsigned char) text[i]];
+            if (symbol < 0) break;
+            state = beforeDFSM.next(state, symbol);
+            work++;
+            if (beforeDead[state]) break;
+            if (beforeDFSM.accepting[state]) first = i;
+        }
+
+        size_t after = at + literal.size();
+        last = afterDFSM.accepting[0] ? after : none;
+        state = 0;
+        for (size_t i = after; i < length; i++) {
+            int symbol = symbolMap[(unsigned char) text[i]];
+            if (symbol < 0) break;
+            state = afterDFSM.next(state, symbol);
+            work++;
+            if (afterDead[state]) break;
+            if (afterDFSM.accepting[state]) last = i + 1;
+        }
+        return first != none && last != none;
+    }
+
+    void prepare(bool prefilter) {
+        symbolMap = forwardDFSM.symbolMap();
+        dead = deadStates(forwardDFSM);
+        prepareReverse();
+        if (prefilter) literal = LiteralFactor::required(forwardDFSM);
+        if (!literal.empty()) prepareWindows();
+    }
+
+    // Subset construction over the reversed forward DFSM. Reverse state 0 is
+    // the accepting forward states, for the end of the text and for a byte
+    // outside the alphabet; reading a symbol backwards leads to the accepting
+    // states and the states it takes into the set. A reverse state accepts when
+    // it holds the forward start state, as a DFSM for any string ending in a
+    // reversed word of the language.
+    void prepareReverse() {
+        int numStates = forwardDFSM.numStates, numSymbols = forwardDFSM.numSymbols();
+        memberWords = (numStates + 63) / 64;
+        reverseDFSM.alphabet = forwardDFSM.alphabet;
+        StateSetTable sets;
+        std::vector<int> subset;
+        for (int state = 0; state < numStates; state++) {
+            if (forwardDFSM.accepting[state]) subset.push_back(state);
+        }
+        bool added;
+        sets.intern(subset, added);
+        for (size_t id = 0; id < sets.subsets.size(); id++) {
+            reverseDFSM.addState();
+            members.resize(members.size() + memberWords, 0);
+            uint64_t* row = &members[id * memberWords];
+            for (int state : sets.subsets[id]) row[state / 64] |= 1ULL << (state % 64);
+            reverseDFSM.accepting[id] = row[0] & 1;
+            for (int symbol = 0; symbol < numSymbols; symbol++) {
+                subset.clear();
+                for (int state = 0; state < numStates; state++) {
+                    if (forwardDFSM.accepting[state] || contains(id, forwardDFSM.next(state, symbol))) {
+                        subset.push_back(state);
+                    }
+                }
+                int target = sets.intern(subset, added);
+                reverseDFSM.transitions[id * numSymbols + symbol] = target;
+            }
+        }
+        startsBefore.resize((size_t) reverseDFSM.numStates * numSymbols);
+        for (int state = 0; state < reverseDFSM.numStates; state++) {
+            for (int symbol = 0; symbol < numSymbols; symbol++) {
+                startsBefore[(size_t) state * numSymbols + symbol] = contains(state, forwardDFSM.next(0, symbol));
+            }
+        }
+    }
+
+    // A match x·literal·y needs x·literal to lead to a live forward state, and y
+    // to be accepted from the state it leads to
+    void prepareWindows() {
+        int numStates = forwardDFSM.numStates, numSymbols = forwardDFSM.numSymbols();
+        DFSM before = forwardDFSM;
+        NDFSM after;
+        after.alphabet = forwardDFSM.alphabet;
+        after.alphabet.push_back('$');
+        after.addState();
+        for (int state = 0; state < numStates; state++) after.addState();
+
+        std::set<int> entered;
+        for (int state = 0; state < numStates; state++) {
+            int reached = state;
+            for (char ch : literal) reached = forwardDFSM.next(reached, symbolMap[(unsigned char) ch]);
+            before.accepting[state] = !dead[reached];
+            if (!dead[reached] && entered.insert(reached).second) {
+                after.addTransition(0, after.epsilonIndex(), reached + 1);
+            }
+            for (int symbol = 0; symbol < numSymbols; symbol++) {
+                after.addTransition(state + 1, symbol, forwardDFSM.next(state, symbol) + 1);
+            }
+            if (forwardDFSM.accepting[state]) after.acceptingStates.insert(state + 1);
+        }
+        after.finish();
+
+        beforeDFSM = DFSMMinimizer::minimize(NDFSMtoDFSM::convertToDFSM(ReverseFSM::reverse(before)));
+        afterDFSM = DFSMMinimizer::minimize(NDFSMtoDFSM::convertToDFSM(after));
+        beforeDead = deadStates(beforeDFSM);
+        afterDead = deadStates(afterDFSM);
+    }
+
+    // States from which no accepting state is reachable, found backwards from the accepting ones
+    static std::vector<char> deadStates(const DFSM& dfsm) {
+        int numStates = dfsm.numStates, numSymbols = dfsm.numSymbols();
+        std::vector<std::vector<int>> predecessors(numStates);
+        for (int state = 0; state < numStates; state++) {
+            for (int symbol = 0; symbol < numSymbols; symbol++) {
+                predecessors[dfsm.next(state, symbol)].push_back(state);
+            }
+        }
+        std::vector<char> dead(numStates, 1);
+        std::vector<int> queue;
+        for (int state = 0; state < numStates; state++) {
+            if (dfsm.accepting[state]) {
+                dead[state] = 0;
+                queue.push_back(state);
+            }
+        }
+        for (size_t head = 0; head < queue.size(); head++) {
+            for (int previous : predecessors[queue[head]]) {
+                if (dead[previous]) {
+                    dead[previous] = 0;
+                    queue.push_back(previous);
+                }
+            }
+        }
+        return dead;
+    }
+
+    // First marked start at or after 'position', or 'length' if there is none
+    static size_t nextStart(const std::vector<uint64_t>& starts, size_t position, size_t length) {
+        if (position >= length) return length;
+        size_t word = position / 64;
+        uint64_t bits = starts[word] & (~0ULL << (position % 64));
+        while (!bits) {
+            if (++word == starts.size()) return length;
+            bits = starts[word];
+        }
+        return word * 64 + __builtin_ctzll(bits);
+    }
+};
+
+#endif
@@ -0,0 +1,89 @@
+// ExtentSearchTest Program
+// Checks ExtentSearch against a brute-force leftmost-longest search with
+// std::regex over random texts, with and without the literal prefilter, and
+// checks that a search stays linear on inputs where extending every start
+// to the end of the text would be quadratic.
+//
+// HOW TO RUN THE CODE:
+// >>g++ -std=c++17 -O2 -o ExtentSearchTest ExtentSearchTest.cpp
+// >>./ExtentSearchTest
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <regex>
+#include <chrono>
+#include <utility>
+
+#include "ExtentSearch.h"
+#include "RegexToNDFSM.h"
+#include "TestCheck.h"
+
+typedef std::vector<std::pair<size_t, size_t>> Extents;
+
+static Extents search(const ExtentSearch& search, const std::string& text) {
+    Extents found;
+    search.find(text.data(), text.size(), [&](size_t start, size_t end) { found.push_back({start, end}); });
+    return found;
+}
+
+// Non-overlapping, leftmost start first, longest non-empty match from it
+static Extents bruteForce(const std::regex& regex, const std::string& text) {
+    Extents found;
+    size_t position = 0;
+    while (position < text.size()) {
+        bool matched = false;
+        for (size_t start = position; start < text.size() && !matched; start++) {
+            for (size_t end = text.size(); end > start; end--) {
+                if (std::regex_match(text.begin() + start, text.begin() + end, regex)) {
+                    found.push_back({start, end});
+                    position = end;
+                    matched = true;
+                    break;
+                }
+            }
+        }
+        if (!matched) break;
+    }
+    return found;
+}
+
+int main() {
+    TestCheck check("ExtentSearchTest");
+    std::mt19937 random(46);
+    const std::vector<std::string> regexes = {
+        "ab*", "a|bc", "(ab)+", "a*b", "c(a|b)*d", "b?a", "(a|b)(c|d)", "d+", "a(bc)*a", "[ab]+c?",
+        "abd", "(a|b)*cab(a|b)*", "ab(c|d)*ab", "c*abcd*", "(ab|ba)dd", "a*ddb*", "dcba", "a*", "(ab)*c?",
+        "a|a*b"
+    };
+    const std::vector<std::string> pools = {"abcdx\n", "aaaabbbbcd", "abdxxxxxxxxx", "abcd"};
+
+    for (const std::string& pattern : regexes) {
+        NDFSM ndfsm = RegexToNDFSM::compile("^" + pattern + "$", "abcd");
+        ExtentSearch plain(ndfsm, false), prefiltered(ndfsm);
+        std::regex regex(pattern);
+        for (int round = 0; round < 40; round++) {
+            std::string text = TestCheck::randomText(random, pools[round % pools.size()], random() % 100);
+            Extents expected = bruteForce(regex, text);
+            check.expect(search(plain, text) == expected, pattern + " on \"" + text + "\"");
+            check.expect(search(prefiltered, text) == expected, pattern + " on \"" + text + "\" with the prefilter");
+        }
+    }
+
+    // Every 'a' is a match that could still grow into a*b; the search has to
+    // stop each match right after it instead of running on to the end
+    ExtentSearch trap(RegexToNDFSM::compile("^(a|a*b)$", "ab"), false);
+    std::string text(1 << 18, 'a');
+    auto started = std::chrono::steady_clock::now();
+    Extents found = search(trap, text);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    check.expect(found.size() == text.size() && found.back() == std::make_pair(text.size() - 1, text.size()),
+                 "(a|a*b) on a run of a's finds one match per a");
+    check.expect(seconds < 1, "(a|a*b) on 256 KB of a's took " + std::to_string(seconds) + " s");
+    text.back() = 'b';
+    found = search(trap, text);
+    check.expect(found.size() == 1 && found[0] == std::make_pair((size_t) 0, text.size()),
+                 "(a|a*b) on a run of a's ending in b is one match");
+
+    return check.finish();
+}
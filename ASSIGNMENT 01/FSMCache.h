@@ -0,0 +1,207 @@
+// FSMCache.h
+#ifndef FSMCACHE_H
+#define FSMCACHE_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <system_error>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include "NDFSM.h"
+#include "DFSM.h"
+
+// 128-bit content hash built from two independent 64-bit lanes, so an
+// accidental collision needs both to collide at once
+class ContentHash {
+public:
+    void add(uint64_t value) {
+        first = (first ^ value) * 0x100000001B3ULL;
+        first ^= first >> 29;
+        second += value * 0x9E3779B97F4A7C15ULL;
+        second = (second << 31 | second >> 33) * 0xC2B2AE3D27D4EB4FULL;
+    }
+
+    void add(const std::string& text) {
+        add(text.size());
+        for (unsigned char ch : text) add(ch);
+    }
+
+    std::string hex() const {
+        char buffer[33];
+        snprintf(buffer, sizeof(buffer), "%016llx%016llx", (unsigned long long) first, (unsigned long long) second);
+        return buffer;
+    }
+
+private:
+    uint64_t first = 0xCBF29CE484222325ULL;
+    uint64_t second = 0x2545F4914F6CDD1DULL;
+};
+
+// Persistent cache of compiled DFSMs in a directory, one binary DFSM file
+// per key. Keys are content hashes of what the DFSM was built from: either
+// the NDFSM itself or a pattern plus the builder options.
+//
+// Entries are written to a temporary file and renamed into place, so
+// concurrent runs never see a half-written entry. A hit refreshes the file's
+// modification time; after each store the least recently used entries are
+// removed until the directory is within its size cap, along with temporary
+// files that a crashed run left behind.
+class FSMCache {
+public:
+    explicit FSMCache(const std::string& directory, uint64_t maxBytes = (uint64_t) 256 << 20)
+        : directory(directory), maxBytes(maxBytes) {
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        if (error) {
+            throw std::runtime_error("Could not create cache directory: " + directory);
+        }
+    }
+
+    // Key of an NDFSM and the conversion options. The transitions are hashed
+    // per state and symbol, so the dense and sparse layouts of the same
+    // machine share a key.
+    static std::string keyFor(const NDFSM& ndfsm, const std::string& options) {
+        ContentHash hash;
+        hash.add(std::string("ndfsm"));
+        hash.add(options);
+        hash.add(std::string(ndfsm.alphabet.begin(), ndfsm.alphabet.end()));
+        hash.add(ndfsm.numStates());
+        for (int state = 0; state < ndfsm.numStates(); state++) {
+            uint32_t cell = ndfsm.firstExplicitCell(state);
+            for (int symbol = 0; symbol <= ndfsm.numSymbols(); symbol++) {
+                NDFSM::Targets targets = ndfsm.defaultTargets(state);
+                if (symbol == ndfsm.epsilonIndex()) {
+                    targets = ndfsm.epsilonTargets(state);
+                } else if (cell < ndfsm.endExplicitCell(state) && ndfsm.cellSymbols[cell] == symbol) {
+                    targets = ndfsm.cellTargets(cell++);
+                }
+                hash.add(targets.size());
+                for (int target : targets) hash.add(target);
+            }
+        }
+        hash.add(ndfsm.acceptingStates.size());
+        for (int state : ndfsm.acceptingStates) hash.add(state);
+        return hash.hex();
+    }
+
+    // Key of a pattern compiled by a named builder with the given options
+    static std::string keyFor(const std::string& builder, const std::string& pattern, const std::string& options) {
+        ContentHash hash;
+        hash.add(std::string("pattern"));
+        hash.add(builder);
+        hash.add(options);
+        hash.add(pattern);
+        return hash.hex();
+    }
+
+    bool load(const std::string& key, DFSM& dfsm) {
+        std::string path = entryPath(key);
+        std::error_code error;
+        if (!std::filesystem::exists(path, error)) {
+            misses++;
+            return false;
+        }
+        try {
+            dfsm.readFromFile(path);
+        } catch (const std::exception& e) {
+            // A damaged entry is a miss; it is replaced by the next store
+            std::filesystem::remove(path, error);
+            misses++;
+            return false;
+        }
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+        hits++;
+        return true;
+    }
+
+    void store(const std::string& key, const DFSM& dfsm) {
+        std::string path = entryPath(key);
+        std::string temporary = path + ".tmp." + std::to_string(processId());
+        std::error_code error;
+        try {
+            dfsm.writeBinaryFile(temporary);
+        } catch (...) {
+            std::filesystem::remove(temporary, error);
+            throw;
+        }
+        std::filesystem::rename(temporary, path, error);
+        if (error) {
+            std::filesystem::remove(temporary, error);
+            throw std::runtime_error("Could not store cache entry: " + path);
+        }
+        evict();
+    }
+
+    uint64_t cacheHits() const { return hits; }
+    uint64_t cacheMisses() const { return misses; }
+
+private:
+    // A temporary file this old belongs to a run that did not finish
+    static constexpr std::chrono::minutes staleTemporary{10};
+
+    std::string directory;
+    uint64_t maxBytes;
+    uint64_t hits = 0, misses = 0;
+
+    std::string entryPath(const std::string& key) const {
+        return (std::filesystem::path(directory) / (key + ".dfsm")).string();
+    }
+
+    static long processId() {
+#ifndef _WIN32
+        return getpid();
+#else
+        return 0;
+#endif
+    }
+
+    static bool isTemporary(const std::filesystem::path& path) {
+        return path.filename().string().find(".dfsm.tmp.") != std::string::npos;
+    }
+
+    // Removes stale temporary files, then the least recently used entries
+    // until the cache fits its cap
+    void evict() {
+        struct Entry {
+            std::filesystem::file_time_type time;
+            uint64_t size;
+            std::filesystem::path path;
+        };
+        std::vector<Entry> entries;
+        uint64_t total = 0;
+        std::error_code error;
+        auto now = std::filesystem::file_time_type::clock::now();
+        for (const auto& file : std::filesystem::directory_iterator(directory, error)) {
+            bool temporary = isTemporary(file.path());
+            if (!temporary && file.path().extension() != ".dfsm") continue;
+            std::error_code fileError;
+            uint64_t size = file.file_size(fileError);
+            auto time = file.last_write_time(fileError);
+            if (fileError) continue;
+            if (temporary) {
+                if (now - time > staleTemporary) std::filesystem::remove(file.path(), fileError);
+                continue;
+            }
+            entries.push_back({time, size, file.path()});
+            total += size;
+        }
+        if (total <= maxBytes) return;
+
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.time < b.time; });
+        for (const Entry& entry : entries) {
+            if (total <= maxBytes) break;
+            std::filesystem::remove(entry.path, error);
+            total -= entry.size;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,237 @@
+// FSMSimulator Program
+// Decides whether an input string is accepted, either by a DFSM table or
+// directly by an NDFSM: with DFSM states built lazily while the input is read
+// (for machines whose full subset construction is too large), or with the
+// active NDFSM states kept as a bitset (for one-off patterns).
+//
+// A DFSM table is run with state numbers of 8, 16 or 32 bits, whichever is
+// the smallest that fits. Tables of 8 MB and more are placed in transparent
+// huge pages; --pages chooses small, thp or huge (explicit 2 MB pages) instead.
+// States that loop on most symbols are skipped through with a byte search up
+// to the next byte that leaves them; --no-skip runs every byte through the
+// table.
+//
+// By default spaces and newlines are skipped, any other byte outside the
+// alphabet is an error and an empty input is accepted or rejected like any
+// other. --variant selects the input rules of one of the C simulators (A,
+// A1A, B, A1B1 or ASSIGNMENT01), and the other options change single rules.
+//
+// HOW TO RUN THE CODE:
+// >>g++ -std=c++17 -O2 -o FSMSimulator FSMSimulator.cpp
+// >>./FSMSimulator [--pages small|thp|huge] [--no-skip] [--stats] DFSM.txt INPUT.txt
+// >>./FSMSimulator [--variant <name>] [--blanks skip|whitespace|keep] [--unknown error|ignore]
+//                  [--empty accept|reject] [--alphabet any|letters|printable] [--unique-alphabet] DFSM.txt INPUT.txt
+// >>./FSMSimulator --lazy [--cache-mb <megabytes>] [-v] [--stats] NFSM.txt INPUT.txt
+// >>./FSMSimulator --nfa [-v] [--stats] NFSM.txt INPUT.txt
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+
+#include "DFSM.h"
+#include "LazyDFA.h"
+#include "BitNFA.h"
+#include "MappedFile.h"
+#include "DFSMEngine.h"
+#include "Stats.h"
+
+// The table is narrowed to the smallest state ID width that fits and run by
+// the engine specialized for the input policy; 'pages' < 0 picks huge pages
+// for large tables only
+static bool runDFSM(const std::string& dfsmFile, const MappedFile& input, const InputPolicy& policy, int pages, bool skipLoops, Stats* stats) {
+    DFSM dfsm;
+    Stats::Stage read(stats, "read_dfsm");
+    dfsm.readFromFile(dfsmFile);
+    read.stop();
+    size_t tableBytes = dfsm.transitions.size() * stateIdBytes(dfsm.numStates);
+    if (stats) {
+        stats->set("dfa_states", dfsm.numStates);
+        stats->set("state_id_bytes", stateIdBytes(dfsm.numStates));
+        stats->set("table_bytes", tableBytes);
+    }
+    if (pages < 0) pages = tableBytes >= hugeTableThreshold ? transparentHugePages : smallPages;
+
+    TLBMissCounter tlbMisses;
+    Stats::Stage place(stats, "place_table");
+    int current = withDFSMEngine(dfsm, policy, (PagePolicy) pages, skipLoops, [&](const auto& engine) {
+        place.stop();
+        if (stats) stats->set("loop_states", engine.numLoopStates());
+        if (stats && pages != smallPages) {
+            stats->set("huge_backed_bytes", engine.table().hugeBackedBytes());
+            stats->set("explicit_huge_pages", engine.table().policy() == explicitHugePages);
+        }
+        Stats::Stage simulate(stats, "simulate");
+        simulate.addBytes(input.size());
+        tlbMisses.start();
+        return engine.run(input.data(), input.size());
+    });
+    uint64_t misses = tlbMisses.stop();
+    if (stats && tlbMisses.available()) stats->set("dtlb_load_misses", misses);
+    return dfsm.accepting[current];
+}
+
+static NDFSM readNDFSM(const std::string& ndfsmFile, Stats* stats) {
+    NDFSM ndfsm;
+    Stats::Stage read(stats, "read_ndfsm");
+    ndfsm.readFromFile(ndfsmFile);
+    if (ndfsm.numStates() == 0) {
+        throw std::runtime_error("NDFSM has no states");
+    }
+    if (stats) stats->set("nfa_states", ndfsm.numStates());
+    return ndfsm;
+}
+
+static bool runLazy(const std::string& ndfsmFile, const MappedFile& input, size_t cacheBytes, bool verbose, Stats* stats) {
+    NDFSM ndfsm = readNDFSM(ndfsmFile, stats);
+
+    Stats::Stage setup(stats, "epsilon_closure");
+    LazyDFA lazy(ndfsm, cacheBytes);
+    setup.stop();
+    Stats::Stage simulate(stats, "simulate");
+    simulate.addBytes(input.size());
+    bool accepted = lazy.accepts(input.data(), input.size());
+    simulate.stop();
+
+    const LazyDFA::Statistics& counts = lazy.statistics();
+    if (stats) {
+        stats->set("steps", counts.steps);
+        stats->set("cache_hits", counts.cacheHits);
+        stats->set("subsets_explored", counts.statesBuilt);
+        stats->set("cache_flushes", counts.flushes);
+        stats->set("peak_cache_bytes", counts.peakCacheBytes);
+    }
+
+    if (verbose) {
+        std::cerr << "steps: " << counts.steps << "\n"
+                  << "cache hits: " << counts.cacheHits << " (" << counts.hitRate() * 100 << "%)\n"
+                  << "states built: " << counts.statesBuilt << "\n"
+                  << "cache flushes: " << counts.flushes << "\n"
+                  << "peak cache bytes: " << counts.peakCacheBytes << std::endl;
+    }
+    return accepted;
+}
+
+static bool runBitNFA(const std::string& ndfsmFile, const MappedFile& input, bool verbose, Stats* stats) {
+    NDFSM ndfsm = readNDFSM(ndfsmFile, stats);
+
+    Stats::Stage setup(stats, "successor_masks");
+    BitNFA nfa(ndfsm);
+    setup.stop();
+    if (stats) stats->set("shift_and", nfa.isShiftAnd());
+    if (verbose) {
+        std::cerr << "engine: " << (nfa.isShiftAnd() ? "shift-and" : "bitset rows") << "\n"
+                  << "words per state set: " << nfa.numWords() << "\n"
+                  << "successor row bytes: " << nfa.rowBytes() << std::endl;
+    }
+    Stats::Stage simulate(stats, "simulate");
+    simulate.addBytes(input.size());
+    return nfa.accepts(input.data(), input.size());
+}
+
+int main(int argc, char* argv[]) {
+    bool wantStats = Stats::takeFlag(argc, argv);
+    Stats stats("FSMSimulator");
+    Stats* statsOut = wantStats ? &stats : nullptr;
+    bool lazy = false, bitNFA = false, verbose = false;
+    size_t cacheMegabytes = 64;
+    int pages = -1;
+    std::string variant = "default", blanks, unknown, empty, alphabet;
+    bool uniqueAlphabet = false, policyOptions = false, skipLoops = true;
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; arg++) {
+        std::string option = argv[arg];
+        if (option == "--lazy") {
+            lazy = true;
+        } else if (option == "--nfa") {
+            bitNFA = true;
+        } else if (option == "-v") {
+            verbose = true;
+        } else if (option == "--cache-mb" && arg + 1 < argc && atoi(argv[arg + 1]) > 0) {
+            cacheMegabytes = atoi(argv[++arg]);
+        } else if (option == "--pages" && arg + 1 < argc) {
+            try {
+                pages = parsePagePolicy(argv[++arg]);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+                return 1;
+            }
+        } else if (option == "--no-skip") {
+            skipLoops = false;
+        } else if (option == "--variant" && arg + 1 < argc) {
+            variant = argv[++arg];
+            policyOptions = true;
+        } else if (option == "--blanks" && arg + 1 < argc) {
+            blanks = argv[++arg];
+            policyOptions = true;
+        } else if (option == "--unknown" && arg + 1 < argc) {
+            unknown = argv[++arg];
+            policyOptions = true;
+        } else if (option == "--empty" && arg + 1 < argc) {
+            empty = argv[++arg];
+            policyOptions = true;
+        } else if (option == "--alphabet" && arg + 1 < argc) {
+            alphabet = argv[++arg];
+            policyOptions = true;
+        } else if (option == "--unique-alphabet") {
+            uniqueAlphabet = true;
+            policyOptions = true;
+        } else {
+            arg = argc;
+        }
+    }
+
+    // The variant first, then the single rules on top of it
+    InputPolicy policy;
+    bool validPolicy = true;
+    try {
+        policy = InputPolicy::variant(variant);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    if (!blanks.empty()) {
+        validPolicy &= blanks == "skip" || blanks == "whitespace" || blanks == "keep";
+        policy.blanks = blanks == "whitespace" ? InputPolicy::skipWhitespace : blanks == "keep" ? InputPolicy::keepBlanks : InputPolicy::skipBlanks;
+    }
+    if (!unknown.empty()) {
+        validPolicy &= unknown == "error" || unknown == "ignore";
+        policy.rejectUnknown = unknown != "ignore";
+    }
+    if (!empty.empty()) {
+        validPolicy &= empty == "accept" || empty == "reject";
+        policy.rejectEmpty = empty == "reject";
+    }
+    if (!alphabet.empty()) {
+        validPolicy &= alphabet == "any" || alphabet == "letters" || alphabet == "printable";
+        policy.alphabet = alphabet == "letters" ? InputPolicy::letters : alphabet == "printable" ? InputPolicy::printable : InputPolicy::anySymbols;
+    }
+    policy.uniqueAlphabet |= uniqueAlphabet;
+
+    if (argc - arg != 2 || !validPolicy || (lazy && bitNFA) || ((lazy || bitNFA) && (pages >= 0 || policyOptions || !skipLoops))) {
+        std::cerr << "Usage: " << argv[0] << " [--pages small|thp|huge] [--no-skip] [--stats] <DFSM file> <input string file>\n"
+                  << "       " << argv[0] << " [--variant A|A1A|B|A1B1|ASSIGNMENT01] [--blanks skip|whitespace|keep] [--unknown error|ignore]\n"
+                  << "       " << std::string(strlen(argv[0]), ' ') << " [--empty accept|reject] [--alphabet any|letters|printable] [--unique-alphabet] <DFSM file> <input string file>\n"
+                  << "       " << argv[0] << " --lazy [--cache-mb <megabytes>] [-v] [--stats] <NDFSM file> <input string file>\n"
+                  << "       " << argv[0] << " --nfa [-v] [--stats] <NDFSM file> <input string file>" << std::endl;
+        return 1;
+    }
+
+    try {
+        MappedFile input(argv[arg + 1]);
+        bool accepted;
+        if (lazy) {
+            accepted = runLazy(argv[arg], input, cacheMegabytes << 20, verbose, statsOut);
+        } else if (bitNFA) {
+            accepted = runBitNFA(argv[arg], input, verbose, statsOut);
+        } else {
+            accepted = runDFSM(argv[arg], input, policy, pages, skipLoops, statsOut);
+        }
+        std::cout << (accepted ? "yes" : "no") << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    if (wantStats) stats.report();
+    return 0;
+}
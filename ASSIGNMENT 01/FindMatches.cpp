@@ -0,0 +1,92 @@
+// FindMatches Program
+// Prints the start and end offset of every leftmost-longest match of a
+// machine's language in a text, one "<start> <end>" line per match with the
+// end exclusive, followed by the match count. The machine is an NDFSM or,
+// with --dfsm, a DFSM, and its language is the set of match words: compile a
+// regex anchored as "^...$", since an unanchored RegexToNDFSM machine accepts
+// whole texts that contain a match. Matches do not overlap and empty matches
+// are not reported.
+//
+// When every match must contain some literal, the DFSMs only run over
+// windows around the literal's occurrences; --no-prefilter scans the whole
+// text instead.
+//
+// HOW TO RUN THE CODE:
+// >>g++ -std=c++17 -O2 -o FindMatches FindMatches.cpp
+// >>./FindMatches [--dfsm] [--count] [--no-prefilter] [--stats] NFSM.txt INPUT.txt
+
+#include <iostream>
+#include <string>
+#include <memory>
+
+#include "ExtentSearch.h"
+#include "MappedFile.h"
+#include "Stats.h"
+
+int main(int argc, char* argv[]) {
+    bool wantStats = Stats::takeFlag(argc, argv);
+    Stats stats("FindMatches");
+    Stats* statsOut = wantStats ? &stats : nullptr;
+    bool fromDFSM = false, countOnly = false, prefilter = true;
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; arg++) {
+        std::string option = argv[arg];
+        if (option == "--dfsm") {
+            fromDFSM = true;
+        } else if (option == "--count") {
+            countOnly = true;
+        } else if (option == "--no-prefilter") {
+            prefilter = false;
+        } else {
+            arg = argc;
+        }
+    }
+    if (argc - arg != 2) {
+        std::cerr << "Usage: " << argv[0] << " [--dfsm] [--count] [--no-prefilter] [--stats] <NDFSM or DFSM file> <input file>" << std::endl;
+        return 1;
+    }
+
+    try {
+        std::unique_ptr<ExtentSearch> search;
+        Stats::Stage build(statsOut, "build_automata");
+        if (fromDFSM) {
+            DFSM dfsm;
+            dfsm.readFromFile(argv[arg]);
+            search.reset(new ExtentSearch(dfsm, prefilter));
+        } else {
+            NDFSM ndfsm;
+            ndfsm.readFromFile(argv[arg]);
+            if (ndfsm.numStates() == 0) {
+                throw std::runtime_error("NDFSM has no states");
+            }
+            search.reset(new ExtentSearch(ndfsm, prefilter));
+        }
+        build.stop();
+        stats.set("forward_states", search->forward().numStates);
+        stats.set("reverse_states", search->reverse().numStates);
+        stats.set("factor_bytes", search->factor().size());
+
+        MappedFile input(argv[arg + 1]);
+        std::string out;
+        ExtentSearch::PrefilterCounts counts;
+        Stats::Stage scan(statsOut, "search");
+        scan.addBytes(input.size());
+        size_t matches = search->find(input.data(), input.size(), [&](size_t start, size_t end) {
+            if (!countOnly) out += std::to_string(start) + " " + std::to_string(end) + "\n";
+        }, &counts);
+        scan.stop();
+        stats.set("matches", matches);
+        if (!search->factor().empty()) {
+            stats.set("candidates", counts.candidates);
+            stats.set("windows", counts.windows);
+            stats.set("window_bytes", counts.windowBytes);
+            stats.set("full_scan", counts.fullScan);
+        }
+        std::cout << out << matches << " matches" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    if (wantStats) stats.report();
+    return 0;
+}
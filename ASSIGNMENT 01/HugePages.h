@@ -0,0 +1,274 @@
+// HugePages.h
+#ifndef HUGEPAGES_H
+#define HUGEPAGES_H
+
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <stdexcept>
+#include <thread>
+
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <linux/perf_event.h>
+#endif
+
+// Placement of large transition tables. A DFSM run touches one row per input
+// symbol, so once the table is tens of MB nearly every step misses the TLB
+// with 4 KB pages; 2 MB pages cover the same table with 512 times fewer
+// entries. Linux only: elsewhere every table is on the heap in ordinary
+// pages, threads are not pinned and TLB misses are not counted.
+enum PagePolicy {
+    smallPages,           // Ordinary 4 KB pages
+    transparentHugePages, // 2 MB aligned and madvise(MADV_HUGEPAGE)
+    explicitHugePages     // MAP_HUGETLB from the reserved pool, else transparent
+};
+
+const size_t hugePageBytes = 2 << 20;
+
+// Tables at least this large are worth copying into huge pages
+const size_t hugeTableThreshold = 8 << 20;
+
+inline PagePolicy parsePagePolicy(const std::string& name) {
+    if (name == "small") return smallPages;
+    if (name == "thp") return transparentHugePages;
+    if (name == "huge") return explicitHugePages;
+    throw std::runtime_error("Unknown page policy '" + name + "' (small, thp or huge)");
+}
+
+inline const char* pagePolicyName(PagePolicy policy) {
+    switch (policy) {
+        case smallPages: return "small";
+        case transparentHugePages: return "thp";
+        default: return "huge";
+    }
+}
+
+// Anonymous mapping with the requested page policy. Explicit huge pages fall
+// back to transparent ones when the hugetlb pool is empty; policy() tells
+// which one was used.
+class PagedBuffer {
+public:
+    PagedBuffer() = default;
+
+    PagedBuffer(size_t bytes, PagePolicy requested) {
+        size_t rounded = (bytes + hugePageBytes - 1) / hugePageBytes * hugePageBytes;
+        if (rounded == 0) rounded = hugePageBytes;
+#ifdef __linux__
+        if (requested == explicitHugePages) {
+            void* p = mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED) {
+                base = static_cast<char*>(p);
+                length = rounded;
+                effective = explicitHugePages;
+                return;
+            }
+            requested = transparentHugePages;
+        }
+
+        // Over-allocate by one huge page and trim, so the table starts on a 2 MB boundary
+        size_t mapped = requested == smallPages ? rounded : rounded + hugePageBytes;
+        void* p = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            throw std::runtime_error(std::string("Could not map table memory: ") + strerror(errno));
+        }
+        char* start = static_cast<char*>(p);
+        if (requested != smallPages) {
+            char* aligned = reinterpret_cast<char*>(((uintptr_t) start + hugePageBytes - 1) & ~(uintptr_t) (hugePageBytes - 1));
+            if (aligned > start) munmap(start, aligned - start);
+            size_t tail = (start + mapped) - (aligned + rounded);
+            if (tail) munmap(aligned + rounded, tail);
+            start = aligned;
+            madvise(start, rounded, MADV_HUGEPAGE);
+        }
+        base = start;
+        length = rounded;
+        effective = requested;
+#else
+        (void) requested;
+        base = static_cast<char*>(::operator new(rounded));
+        length = rounded;
+#endif
+    }
+
+    ~PagedBuffer() {
+#ifdef __linux__
+        if (base) munmap(base, length);
+#else
+        ::operator delete(base);
+#endif
+    }
+
+    PagedBuffer(PagedBuffer&& other) noexcept : base(other.base), length(other.length), effective(other.effective) {
+        other.base = nullptr;
+    }
+
+    PagedBuffer& operator=(PagedBuffer&& other) noexcept {
+        std::swap(base, other.base);
+        std::swap(length, other.length);
+        std::swap(effective, other.effective);
+        return *this;
+    }
+
+    char* data() const { return base; }
+    size_t size() const { return length; }
+    PagePolicy policy() const { return effective; }
+
+    // Bytes of the buffer that the kernel actually backs with huge pages
+    size_t hugeBackedBytes() const {
+#ifdef __linux__
+        std::ifstream smaps("/proc/self/smaps");
+        std::string line;
+        bool inside = false;
+        size_t kilobytes = 0;
+        while (std::getline(smaps, line)) {
+            uintptr_t low, high;
+            if (sscanf(line.c_str(), "%lx-%lx ", &low, &high) == 2 && line.find(':') > line.find('-')) {
+                inside = low < (uintptr_t) (base + length) && high > (uintptr_t) base;
+                continue;
+            }
+            if (!inside) continue;
+            size_t value;
+            if (sscanf(line.c_str(), "AnonHugePages: %zu kB", &value) == 1 ||
+                sscanf(line.c_str(), "Private_Hugetlb: %zu kB", &value) == 1) {
+                kilobytes += value;
+            }
+        }
+        return kilobytes * 1024;
+#else
+        return 0;
+#endif
+    }
+
+private:
+    char* base = nullptr;
+    size_t length = 0;
+    PagePolicy effective = smallPages;
+};
+
+// NUMA nodes and their CPUs from sysfs; a machine without that information,
+// or any system other than Linux, is one node holding every CPU
+class NumaTopology {
+public:
+    NumaTopology() {
+#ifdef __linux__
+        for (int node = 0;; node++) {
+            std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            if (!file) break;
+            std::string list;
+            std::getline(file, list);
+            std::vector<int> cpus = parseCpuList(list);
+            if (!cpus.empty()) nodes.push_back(cpus);
+        }
+#endif
+        if (nodes.empty()) {
+            std::vector<int> all;
+#ifdef __linux__
+            long count = sysconf(_SC_NPROCESSORS_ONLN);
+#else
+            long count = std::thread::hardware_concurrency();
+#endif
+            for (long cpu = 0; cpu < count; cpu++) all.push_back(cpu);
+            nodes.push_back(all);
+        }
+    }
+
+    int numNodes() const { return nodes.size(); }
+    const std::vector<int>& cpusOf(int node) const { return nodes[node]; }
+
+    // Restricts the calling thread to the CPUs of a node
+    bool pinToNode(int node) const {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : nodes[node]) {
+            if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+        }
+        return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+        (void) node;
+        return false;
+#endif
+    }
+
+    // "0-3,8-11" style lists
+    static std::vector<int> parseCpuList(const std::string& list) {
+        std::vector<int> cpus;
+        std::stringstream ranges(list);
+        std::string range;
+        while (std::getline(ranges, range, ',')) {
+            int first, last;
+            int fields = sscanf(range.c_str(), "%d-%d", &first, &last);
+            if (fields < 1) continue;
+            if (fields == 1) last = first;
+            for (int cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+        }
+        return cpus;
+    }
+
+private:
+    std::vector<std::vector<int>> nodes;
+};
+
+// Data-TLB load misses of the calling thread, from the hardware performance
+// counters. Kernels or VMs without the counter, or with perf_event_paranoid
+// set too high, leave available() false.
+class TLBMissCounter {
+public:
+    TLBMissCounter() {
+#ifdef __linux__
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+    }
+
+    ~TLBMissCounter() {
+#ifdef __linux__
+        if (fd >= 0) close(fd);
+#endif
+    }
+
+    TLBMissCounter(const TLBMissCounter&) = delete;
+    TLBMissCounter& operator=(const TLBMissCounter&) = delete;
+
+    bool available() const { return fd >= 0; }
+
+    void start() {
+#ifdef __linux__
+        if (fd < 0) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    uint64_t stop() {
+        uint64_t count = 0;
+#ifdef __linux__
+        if (fd < 0) return 0;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &count, sizeof(count)) != (ssize_t) sizeof(count)) return 0;
+#endif
+        return count;
+    }
+
+private:
+    int fd = -1;
+};
+
+#endif
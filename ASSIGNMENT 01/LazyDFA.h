@@ -0,0 +1,131 @@
+// LazyDFA.h
+#ifndef LAZYDFA_H
+#define LAZYDFA_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <stdexcept>
+
+#include "NDFSM.h"
+#include "EpsilonClosure.h"
+#include "NDFSMtoDFSM.h"
+
+// Runs an NDFSM directly, building DFSM states only when the input reaches
+// them. Built states and their transitions live in a cache bounded by a byte
+// budget; when the budget is exceeded the whole cache is flushed and refilled
+// from the state being entered. A machine whose full subset construction
+// would explode therefore still runs: at worst every step is one subset move,
+// which is the speed of a plain NFA simulation.
+class LazyDFA {
+public:
+    struct Statistics {
+        uint64_t steps = 0;
+        uint64_t cacheHits = 0;
+        uint64_t statesBuilt = 0;
+        uint64_t flushes = 0;
+        size_t peakCacheBytes = 0;
+
+        double hitRate() const { return steps ? (double) cacheHits / steps : 0.0; }
+    };
+
+    LazyDFA(const NDFSM& ndfsm, size_t cacheLimit)
+        : closures(ndfsm), mover(ndfsm, closures), cacheLimit(cacheLimit), numSymbols(ndfsm.numSymbols()),
+          symbolMap(256, -1), isAccepting(ndfsm.numStates(), 0), startSet(closures.closureOf(0)) {
+        for (int i = 0; i < numSymbols; i++) {
+            symbolMap[(unsigned char) ndfsm.alphabet[i]] = i;
+        }
+        for (int state : ndfsm.acceptingStates) isAccepting[state] = 1;
+    }
+
+    const Statistics& statistics() const { return stats; }
+    int cachedStates() const { return table.size(); }
+    size_t cacheBytes() const { return usedBytes; }
+
+    // Runs the whole input like the DFSM simulators: blanks and newlines are
+    // skipped and any other byte outside the alphabet is an error
+    bool accepts(const char* text, size_t length) {
+        int current = enter(startSet);
+        for (size_t i = 0; i < length; i++) {
+            char ch = text[i];
+            if (ch == '\n' || ch == ' ') continue;
+            int symbol = symbolMap[(unsigned char) ch];
+            if (symbol < 0) {
+                throw std::runtime_error(std::string("Character '") + ch + "' is not in the alphabet");
+            }
+            current = step(current, symbol);
+        }
+        return accepting[current];
+    }
+
+    // One transition from a cached state, building the target if needed
+    int step(int current, int symbol) {
+        stats.steps++;
+        size_t slot = (size_t) current * numSymbols + symbol;
+        int target = transitions[slot];
+        if (target >= 0) {
+            stats.cacheHits++;
+            return target;
+        }
+
+        StateSetTable::StateSet states = table.subsets[current];
+        mover.move(states.data(), states.size(), symbol, next);
+        uint64_t before = stats.flushes;
+        target = enter(next);
+        if (stats.flushes == before) {
+            transitions[slot] = target;
+        }
+        return target;
+    }
+
+private:
+    EpsilonClosure closures;
+    SubsetMover mover;
+    size_t cacheLimit;
+    size_t usedBytes = 0;
+    int numSymbols;
+    std::vector<int> symbolMap;
+    std::vector<char> isAccepting;
+    std::vector<int> startSet;
+    std::vector<int> next;
+
+    StateSetTable table;          // Cached state sets; the index is the cached state number
+    std::vector<int> transitions; // Cached transitions, -1 when not built yet
+    std::vector<char> accepting;
+    Statistics stats;
+
+    // Cached number of a state set, adding it and flushing first if the cache is full
+    int enter(const std::vector<int>& states) {
+        bool added;
+        int id = table.intern(states, added);
+        if (!added) return id;
+
+        size_t bytes = numSymbols * sizeof(int) + states.size() * sizeof(int) + sizeof(StateSetTable::StateSet) + 2 * sizeof(uint64_t);
+        if (usedBytes + bytes > cacheLimit && table.size() > 1) {
+            // Copy first: 'states' may be the cached set that is about to go
+            std::vector<int> keep = states;
+            stats.flushes++;
+            table.clear();
+            transitions.clear();
+            accepting.clear();
+            usedBytes = 0;
+            id = table.intern(keep, added);
+        }
+
+        transitions.resize(transitions.size() + numSymbols, -1);
+        char isFinal = 0;
+        for (int state : table.subsets[id]) {
+            if (isAccepting[state]) {
+                isFinal = 1;
+                break;
+            }
+        }
+        accepting.push_back(isFinal);
+        usedBytes += bytes;
+        stats.statesBuilt++;
+        if (usedBytes > stats.peakCacheBytes) stats.peakCacheBytes = usedBytes;
+        return id;
+    }
+};
+
+#endif
@@ -0,0 +1,106 @@
+// LiteralFactor.h
+#ifndef LITERALFACTOR_H
+#define LITERALFACTOR_H
+
+#include <vector>
+#include <string>
+
+#include "DFSM.h"
+
+// Finds a literal that every word of a DFSM's language contains, for
+// prefilters that look for the literal before running the DFSM. Any such
+// factor is a substring of the shortest accepted word, so the candidates are
+// its substrings; a candidate is required when no accepting state can be
+// reached without reading it, checked on the product of the DFSM with the
+// candidate's KMP automaton.
+class LiteralFactor {
+public:
+    // Longest required factor up to maxLength bytes, or "" when there is none
+    static std::string required(const DFSM& dfsm, size_t maxLength = 32) {
+        std::string word;
+        if (!shortestWord(dfsm, word)) return "";
+
+        // Required factors are closed under taking substrings, so one sliding window finds the longest
+        std::string best;
+        size_t first = 0, last = 0;
+        while (last < word.size() && best.size() < maxLength) {
+            if (isRequired(dfsm, word.substr(first, last + 1 - first))) {
+                last++;
+                if (last - first > best.size()) best = word.substr(first, last - first);
+            } else if (first < last) {
+                first++;
+            } else {
+                first++;
+                last++;
+            }
+        }
+        return best;
+    }
+
+    // True when every accepted word contains 'factor'
+    static bool isRequired(const DFSM& dfsm, const std::string& factor) {
+        std::vector<int> symbolMap = dfsm.symbolMap();
+        int length = factor.size(), numSymbols = dfsm.numSymbols();
+        std::vector<int> word;
+        for (char ch : factor) {
+            if (symbolMap[(unsigned char) ch] < 0) return false;
+            word.push_back(symbolMap[(unsigned char) ch]);
+        }
+
+        // KMP automaton: matched[k * numSymbols + a] is the prefix length matched after reading a with k matched
+        std::vector<int> matched((size_t) length * numSymbols, 0);
+        for (int k = 0, border = 0; k < length; k++) {
+            for (int a = 0; a < numSymbols; a++) {
+                matched[(size_t) k * numSymbols + a] = a == word[k] ? k + 1 : (k ? matched[(size_t) border * numSymbols + a] : 0);
+            }
+            if (k) border = matched[(size_t) border * numSymbols + word[k]];
+        }
+
+        // Search the product for an accepting state reached before the factor is complete
+        std::vector<bool> seen((size_t) dfsm.numStates * length, false);
+        std::vector<std::pair<int, int>> queue{{0, 0}};
+        seen[0] = true;
+        for (size_t head = 0; head < queue.size(); head++) {
+            int state = queue[head].first, k = queue[head].second;
+            if (dfsm.accepting[state]) return false;
+            for (int a = 0; a < numSymbols; a++) {
+                int nextK = matched[(size_t) k * numSymbols + a];
+                if (nextK == length) continue;
+                int next = dfsm.next(state, a);
+                size_t pair = (size_t) next * length + nextK;
+                if (!seen[pair]) {
+                    seen[pair] = true;
+                    queue.push_back({next, nextK});
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    // Breadth-first search for a shortest accepted word; false for an empty language
+    static bool shortestWord(const DFSM& dfsm, std::string& word) {
+        std::vector<int> parent(dfsm.numStates, -1), symbolIn(dfsm.numStates, -1);
+        std::vector<int> queue{0};
+        parent[0] = 0;
+        for (size_t head = 0; head < queue.size(); head++) {
+            int state = queue[head];
+            if (dfsm.accepting[state]) {
+                for (; state != 0; state = parent[state]) word += dfsm.alphabet[symbolIn[state]];
+                word.assign(word.rbegin(), word.rend());
+                return true;
+            }
+            for (int symbol = 0; symbol < dfsm.numSymbols(); symbol++) {
+                int next = dfsm.next(state, symbol);
+                if (parent[next] < 0) {
+                    parent[next] = state;
+                    symbolIn[next] = symbol;
+                    queue.push_back(next);
+                }
+            }
+        }
+        return false;
+    }
+};
+
+#endif
@@ -0,0 +1,67 @@
+// MappedFile.h
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Read-only view of a whole file. The file is memory-mapped where the platform
+// allows it, so large patterns and inputs are paged in on demand instead of
+// being copied; otherwise it falls back to reading the file into a buffer.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& filename) {
+#ifndef _WIN32
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Could not open file: " + filename);
+        }
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) {
+                madvise(mapped, info.st_size, MADV_SEQUENTIAL);
+                mappedData = static_cast<const char*>(mapped);
+                mappedSize = info.st_size;
+            }
+        }
+        close(fd);
+        if (mappedData) return;
+#endif
+        std::ifstream reader(filename, std::ios::binary);
+        if (!reader) {
+            throw std::runtime_error("Could not open file: " + filename);
+        }
+        std::stringstream contents;
+        contents << reader.rdbuf();
+        buffer = contents.str();
+    }
+
+    ~MappedFile() {
+#ifndef _WIN32
+        if (mappedData) munmap(const_cast<char*>(mappedData), mappedSize);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return mappedData ? mappedData : buffer.data(); }
+    size_t size() const { return mappedData ? mappedSize : buffer.size(); }
+
+private:
+    const char* mappedData = nullptr;
+    size_t mappedSize = 0;
+    std::string buffer;
+};
+
+#endif
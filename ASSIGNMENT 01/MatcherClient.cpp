@@ -0,0 +1,170 @@
+// MatcherClient Program
+// Test client for MatcherDaemon. Sends the contents of an input file to one
+// of the daemon's machines, optionally many times with several requests in
+// flight, and prints the verdict with the round-trip latencies it observed.
+// With --report it prints the daemon's latency report instead. --stats
+// reports the run itself: requests, bytes sent and round-trip quantiles.
+//
+// HOW TO RUN THE CODE:
+// >>g++ -std=c++17 -O2 -o MatcherClient MatcherClient.cpp
+// >>./MatcherClient /tmp/matcher.sock 0 INPUT.txt
+// >>./MatcherClient [--repeat <count>] [--pipeline <depth>] [--steps <budget>] [--stats] /tmp/matcher.sock 0 INPUT.txt
+// >>./MatcherClient --report /tmp/matcher.sock
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <cstdlib>
+
+#include "MatcherDaemon.h"
+#include "MappedFile.h"
+#include "Stats.h"
+
+static void writeAll(int fd, const std::string& data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t count = write(fd, data.data() + written, data.size() - written);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) throw std::runtime_error("Connection to the daemon lost");
+        written += count;
+    }
+}
+
+static void readAll(int fd, char* data, size_t length) {
+    size_t done = 0;
+    while (done < length) {
+        ssize_t count = read(fd, data + done, length - done);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) throw std::runtime_error("Connection to the daemon lost");
+        done += count;
+    }
+}
+
+// Reads one response; returns its status and fills 'payload'
+static uint32_t readResponse(int fd, uint32_t& id, std::string& payload) {
+    char header[3 * sizeof(uint32_t)];
+    readAll(fd, header, sizeof(header));
+    id = MatcherProtocol::readValue(header);
+    uint32_t status = MatcherProtocol::readValue(header + 4);
+    payload.resize(MatcherProtocol::readValue(header + 8));
+    if (!payload.empty()) readAll(fd, &payload[0], payload.size());
+    return status;
+}
+
+static int connectTo(const std::string& socketPath) {
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path is too long: " + socketPath);
+    }
+    strcpy(address.sun_path, socketPath.c_str());
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (sockaddr*) &address, sizeof(address)) < 0) {
+        throw std::runtime_error("Could not connect to " + socketPath + ": " + strerror(errno));
+    }
+    return fd;
+}
+
+int main(int argc, char* argv[]) {
+    bool wantStats = Stats::takeFlag(argc, argv);
+    Stats stats("MatcherClient");
+    Stats* statsOut = wantStats ? &stats : nullptr;
+    long repeat = 1, pipeline = 1;
+    uint32_t steps = 0;
+    bool report = false;
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; arg++) {
+        std::string option = argv[arg];
+        if (option == "--report") {
+            report = true;
+        } else if (option == "--repeat" && arg + 1 < argc) {
+            repeat = atol(argv[++arg]);
+        } else if (option == "--pipeline" && arg + 1 < argc) {
+            pipeline = atol(argv[++arg]);
+        } else if (option == "--steps" && arg + 1 < argc) {
+            steps = strtoul(argv[++arg], nullptr, 10);
+        } else {
+            arg = argc;
+        }
+    }
+    if ((report ? argc - arg != 1 : argc - arg != 3) || repeat < 1 || pipeline < 1) {
+        std::cerr << "Usage: " << argv[0] << " [--repeat <count>] [--pipeline <depth>] [--steps <budget>] [--stats] <socket path> <machine> <input string file>\n"
+                  << "       " << argv[0] << " --report [--stats] <socket path>" << std::endl;
+        return 1;
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    try {
+        int fd = connectTo(argv[arg]);
+        std::string payload;
+        uint32_t id;
+
+        if (report) {
+            Stats::Stage fetch(statsOut, "report");
+            std::string request;
+            MatcherProtocol::appendValue(request, 0);
+            MatcherProtocol::appendValue(request, 0);
+            MatcherProtocol::appendValue(request, MatcherProtocol::statsMachine);
+            MatcherProtocol::appendValue(request, 0);
+            writeAll(fd, request);
+            readResponse(fd, id, payload);
+            fetch.stop();
+            std::cout << payload;
+            close(fd);
+            if (wantStats) stats.report();
+            return 0;
+        }
+
+        MappedFile input(argv[arg + 2]);
+        uint32_t machine = strtoul(argv[arg + 1], nullptr, 10);
+        auto request = [&](uint32_t requestId) {
+            std::string frame;
+            MatcherProtocol::appendValue(frame, input.size());
+            MatcherProtocol::appendValue(frame, requestId);
+            MatcherProtocol::appendValue(frame, machine);
+            MatcherProtocol::appendValue(frame, steps);
+            frame.append(input.data(), input.size());
+            return frame;
+        };
+
+        // Keep up to 'pipeline' requests in flight; small ones go out together
+        LatencyHistogram histogram;
+        std::deque<std::chrono::steady_clock::time_point> sent;
+        long next = 0, done = 0;
+        uint32_t status = 0;
+        auto start = std::chrono::steady_clock::now();
+        Stats::Stage requests(statsOut, "requests");
+        requests.addBytes((uint64_t) input.size() * repeat);
+        while (done < repeat) {
+            std::string batch;
+            while (next < repeat && next - done < pipeline) {
+                batch += request(next++);
+                sent.push_back(std::chrono::steady_clock::now());
+            }
+            if (!batch.empty()) writeAll(fd, batch);
+            status = readResponse(fd, id, payload);
+            histogram.add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - sent.front()).count());
+            sent.pop_front();
+            done++;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        requests.stop();
+        close(fd);
+        stats.set("requests", repeat);
+        stats.set("pipeline", pipeline);
+        stats.set("round_trip_p50_ns", histogram.quantile(0.5));
+        stats.set("round_trip_p99_ns", histogram.quantile(0.99));
+
+        std::cout << MatcherProtocol::statusName(status) << std::endl;
+        if (repeat > 1) {
+            std::cerr << "round trips: " << histogram.format() << repeat / seconds << " requests/s" << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    if (wantStats) stats.report();
+    return 0;
+}
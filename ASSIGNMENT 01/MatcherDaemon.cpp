@@ -0,0 +1,83 @@
+// MatcherDaemon Program
+// Loads DFSM files once and answers match requests from local clients over a
+// Unix domain socket (see MatcherDaemon.h for the wire format). Machines are
+// numbered from 0 in the order they are given. The latency histogram is
+// printed on exit (Ctrl-C or SIGTERM) and can be requested by clients.
+// With --stats the exit also reports requests, traffic and peak RSS.
+//
+// HOW TO RUN THE CODE:
+// >>g++ -std=c++17 -O2 -o MatcherDaemon MatcherDaemon.cpp
+// >>./MatcherDaemon [--max-steps <steps>] [--stats] /tmp/matcher.sock DFSM.txt [DFSM2.txt ...]
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <csignal>
+
+#include "MatcherDaemon.h"
+#include "Stats.h"
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void requestStop(int) {
+    stopRequested = 1;
+}
+
+int main(int argc, char* argv[]) {
+    bool wantStats = Stats::takeFlag(argc, argv);
+    Stats stats("MatcherDaemon");
+    Stats* statsOut = wantStats ? &stats : nullptr;
+    uint32_t maxSteps = 0xFFFFFFFF;
+    int arg = 1;
+    if (argc > 2 && std::string(argv[1]) == "--max-steps") {
+        maxSteps = strtoul(argv[2], nullptr, 10);
+        arg = 3;
+    }
+    if (argc - arg < 2 || maxSteps == 0) {
+        std::cerr << "Usage: " << argv[0] << " [--max-steps <steps>] [--stats] <socket path> <DFSM file> [<DFSM file> ...]" << std::endl;
+        return 1;
+    }
+
+    // Handlers without SA_RESTART so a signal interrupts poll()
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = requestStop;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+
+    try {
+        MatcherDaemon daemon(argv[arg], maxSteps);
+        Stats::Stage load(statsOut, "load_machines");
+        for (int i = arg + 1; i < argc; i++) {
+            daemon.addMachine(argv[i]);
+            load.addBytes(Stats::fileBytes(argv[i]));
+            stats.add("dfa_states", daemon.machineStates(i - arg - 1));
+            std::cout << "Machine " << i - arg - 1 << ": " << argv[i] << std::endl;
+        }
+        load.stop();
+        stats.set("machines", daemon.numMachines());
+
+        std::cout << "Listening on " << argv[arg] << std::endl;
+        Stats::Stage serve(statsOut, "serve");
+        daemon.run(stopRequested);
+        serve.addBytes(daemon.bytesReceived());
+        serve.stop();
+        std::cout << daemon.latencies().format();
+
+        stats.set("clients", daemon.clientsAccepted());
+        stats.set("requests", daemon.requestsAnswered());
+        stats.set("bytes_received", daemon.bytesReceived());
+        stats.set("bytes_sent", daemon.bytesSent());
+        const LatencyHistogram& latencies = daemon.latencies();
+        if (latencies.count()) {
+            stats.set("latency_p50_ns", latencies.quantile(0.5));
+            stats.set("latency_p99_ns", latencies.quantile(0.99));
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    if (wantStats) stats.report();
+    return 0;
+}
@@ -0,0 +1,382 @@
+// MatcherDaemon.h
+#ifndef MATCHERDAEMON_H
+#define MATCHERDAEMON_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <stdexcept>
+#include <algorithm>
+#include <deque>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "DFSM.h"
+
+// Wire format shared by the daemon and its clients. All integers are 32-bit
+// in native byte order, since both ends run on the same host.
+//
+// A request is a header of four integers (payload length, request ID,
+// machine index, step budget) followed by the input string. A step budget of
+// 0 means the daemon's default. A response is three integers (request ID,
+// status, payload length) followed by the payload, which is empty except for
+// statistics requests. Clients may send any number of requests without
+// waiting; responses come back in request order.
+namespace MatcherProtocol {
+    const uint32_t statsMachine = 0xFFFFFFFF; // Machine index asking for the latency report
+    const uint32_t maxPayload = 64u << 20;
+
+    enum Status : uint32_t {
+        rejected = 0,
+        accepted = 1,
+        budgetExceeded = 2,
+        unknownMachine = 3,
+        invalidSymbol = 4,
+        report = 5
+    };
+
+    inline void appendValue(std::string& out, uint32_t value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    inline uint32_t readValue(const char* p) {
+        uint32_t value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    inline const char* statusName(uint32_t status) {
+        switch (status) {
+            case rejected: return "no";
+            case accepted: return "yes";
+            case budgetExceeded: return "step budget exceeded";
+            case unknownMachine: return "unknown machine";
+            case invalidSymbol: return "symbol not in alphabet";
+            default: return "report";
+        }
+    }
+}
+
+// Latencies in power-of-two nanosecond buckets
+class LatencyHistogram {
+public:
+    static const int numBuckets = 48;
+
+    void add(uint64_t nanoseconds) {
+        int bucket = nanoseconds ? 64 - __builtin_clzll(nanoseconds) : 0;
+        counts[bucket < numBuckets ? bucket : numBuckets - 1]++;
+        total++;
+        if (nanoseconds > maximum) maximum = nanoseconds;
+    }
+
+    uint64_t count() const { return total; }
+
+    // Upper bound of the bucket holding the given quantile
+    uint64_t quantile(double q) const {
+        uint64_t rank = (uint64_t) (q * total), seen = 0;
+        for (int b = 0; b < numBuckets; b++) {
+            seen += counts[b];
+            if (seen > rank) return b == 0 ? 0 : (1ULL << b) - 1;
+        }
+        return maximum;
+    }
+
+    std::string format() const {
+        std::string out = "requests: " + std::to_string(total) + "\n";
+        if (total == 0) return out;
+        out += "p50 <= " + std::to_string(quantile(0.5)) + " ns, p90 <= " + std::to_string(quantile(0.9)) +
+               " ns, p99 <= " + std::to_string(quantile(0.99)) + " ns, max " + std::to_string(maximum) + " ns\n";
+        for (int b = 0; b < numBuckets; b++) {
+            if (counts[b] == 0) continue;
+            uint64_t low = b == 0 ? 0 : 1ULL << (b - 1);
+            out += "  [" + std::to_string(low) + ", " + std::to_string(b == 0 ? 1 : 1ULL << b) + ") ns: " +
+                   std::to_string(counts[b]) + "\n";
+        }
+        return out;
+    }
+
+private:
+    uint64_t counts[numBuckets] = {0};
+    uint64_t total = 0;
+    uint64_t maximum = 0;
+};
+
+// Single-threaded poll() server that answers match requests against DFSMs
+// loaded once at startup. Every complete request in a client's read buffer is
+// answered in one batch and the responses leave in a single write.
+//
+// A request's latency runs from the read that completes its frame to the
+// write that sends the last byte of its answer, so it includes the time the
+// request waits behind others in the batch and in the output buffer.
+// Statistics requests are not counted.
+//
+// Each client's buffers are capped: the daemon stops reading from a client
+// whose input holds a full frame's worth or whose unsent responses pass
+// outputLimit, and stops answering while they do, so a peer that pipelines
+// requests without reading the replies cannot grow them without bound.
+// Reading resumes once the buffers drain.
+class MatcherDaemon {
+public:
+    MatcherDaemon(const std::string& socketPath, uint32_t defaultSteps)
+        : socketPath(socketPath), defaultSteps(defaultSteps) {}
+
+    ~MatcherDaemon() {
+        for (const Client& client : clients) close(client.fd);
+        if (listener >= 0) {
+            close(listener);
+            unlink(socketPath.c_str());
+        }
+    }
+
+    void addMachine(const std::string& fileName) {
+        machines.emplace_back();
+        machines.back().dfsm.readFromFile(fileName);
+        machines.back().symbolMap = machines.back().dfsm.symbolMap();
+    }
+
+    size_t numMachines() const { return machines.size(); }
+    int machineStates(size_t machine) const { return machines[machine].dfsm.numStates; }
+    const LatencyHistogram& latencies() const { return histogram; }
+
+    // Totals over every client since the daemon started
+    uint64_t requestsAnswered() const { return answered; }
+    uint64_t bytesReceived() const { return received; }
+    uint64_t bytesSent() const { return sent; }
+    uint64_t clientsAccepted() const { return accepted; }
+
+    // Serves until 'stop' becomes nonzero
+    void run(volatile sig_atomic_t& stop) {
+        listen();
+        std::vector<pollfd> fds;
+        while (!stop) {
+            fds.clear();
+            fds.push_back({listener, POLLIN, 0});
+            for (const Client& client : clients) {
+                fds.push_back({client.fd, (short) ((wantsInput(client) ? POLLIN : 0) | (client.out.empty() ? 0 : POLLOUT)), 0});
+            }
+            if (poll(fds.data(), fds.size(), -1) < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error(std::string("poll failed: ") + strerror(errno));
+            }
+
+            // Clients first, since accepting appends to 'clients'
+            for (size_t i = clients.size(); i-- > 0;) {
+                short events = fds[i + 1].revents;
+                bool open = true;
+                if (events & POLLERR) open = false;
+                if (open && (events & (POLLIN | POLLHUP))) open = readClient(clients[i]);
+                if (open && (events & POLLOUT)) open = serve(clients[i]);
+                if (!open) {
+                    close(clients[i].fd);
+                    clients.erase(clients.begin() + i);
+                }
+            }
+            if (fds[0].revents & POLLIN) accept();
+        }
+    }
+
+private:
+    struct Machine {
+        DFSM dfsm;
+        std::vector<int> symbolMap;
+    };
+
+    typedef std::chrono::steady_clock Clock;
+
+    // Position in a client's byte stream and the time it was reached
+    struct Mark {
+        uint64_t offset;
+        Clock::time_point time;
+    };
+
+    struct Client {
+        int fd = -1;
+        std::string in, out;
+        bool finished = false; // The peer closed its end; answers still go out
+        uint64_t readBytes = 0, parsedBytes = 0, queuedBytes = 0, sentBytes = 0;
+        std::deque<Mark> reads;   // End of each read from the socket
+        std::deque<Mark> pending; // End of each unsent answer, with its request's arrival
+    };
+
+    static const size_t headerBytes = 4 * sizeof(uint32_t);
+    static const size_t inputLimit = headerBytes + MatcherProtocol::maxPayload;
+    static const size_t outputLimit = 1 << 20;
+
+    std::string socketPath;
+    uint32_t defaultSteps;
+    int listener = -1;
+    std::vector<Machine> machines;
+    std::vector<Client> clients;
+    LatencyHistogram histogram;
+    uint64_t answered = 0, received = 0, sent = 0, accepted = 0;
+
+    static void setNonBlocking(int fd) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+
+    void listen() {
+        sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (socketPath.size() >= sizeof(address.sun_path)) {
+            throw std::runtime_error("Socket path is too long: " + socketPath);
+        }
+        strcpy(address.sun_path, socketPath.c_str());
+
+        listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listener < 0) throw std::runtime_error(std::string("socket failed: ") + strerror(errno));
+        unlink(socketPath.c_str());
+        if (bind(listener, (sockaddr*) &address, sizeof(address)) < 0 || ::listen(listener, 64) < 0) {
+            throw std::runtime_error("Could not listen on " + socketPath + ": " + strerror(errno));
+        }
+        setNonBlocking(listener);
+    }
+
+    void accept() {
+        for (;;) {
+            int fd = ::accept(listener, nullptr, nullptr);
+            if (fd < 0) return;
+            setNonBlocking(fd);
+            clients.emplace_back();
+            clients.back().fd = fd;
+            accepted++;
+        }
+    }
+
+    static bool wantsInput(const Client& client) {
+        return !client.finished && client.in.size() < inputLimit && client.out.size() < outputLimit;
+    }
+
+    // Reads what is available up to the input cap and serves the client;
+    // false when the connection is finished
+    bool readClient(Client& client) {
+        char buffer[1 << 16];
+        while (!client.finished && client.in.size() < inputLimit) {
+            size_t room = std::min(sizeof(buffer), inputLimit - client.in.size());
+            ssize_t count = read(client.fd, buffer, room);
+            if (count > 0) {
+                client.in.append(buffer, count);
+                client.readBytes += count;
+                received += count;
+                client.reads.push_back({client.readBytes, Clock::now()});
+                continue;
+            }
+            if (count < 0 && errno == EINTR) continue;
+            if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            client.finished = true; // Requests already received are still answered
+        }
+        return serve(client);
+    }
+
+    // Answers complete requests while the responses stay under the output
+    // cap and writes them, until the requests run out or the socket is full;
+    // false when the connection is finished
+    bool serve(Client& client) {
+        for (;;) {
+            size_t position = 0;
+            while (client.out.size() < outputLimit && client.in.size() - position >= headerBytes) {
+                const char* frame = client.in.data() + position;
+                uint32_t length = MatcherProtocol::readValue(frame);
+                if (length > MatcherProtocol::maxPayload) return false;
+                if (client.in.size() - position < headerBytes + length) break;
+                uint32_t id = MatcherProtocol::readValue(frame + 4);
+                uint32_t machine = MatcherProtocol::readValue(frame + 8);
+                uint32_t budget = MatcherProtocol::readValue(frame + 12);
+                position += headerBytes + length;
+
+                // The frame arrived with the read holding its last byte
+                uint64_t end = client.parsedBytes + position;
+                while (client.reads.front().offset < end) client.reads.pop_front();
+                Clock::time_point arrived = client.reads.front().time;
+
+                size_t before = client.out.size();
+                answer(client.out, id, machine, budget ? budget : defaultSteps, frame + headerBytes, length);
+                client.queuedBytes += client.out.size() - before;
+                if (machine != MatcherProtocol::statsMachine) {
+                    client.pending.push_back({client.queuedBytes, arrived});
+                    answered++;
+                }
+            }
+            client.in.erase(0, position);
+            client.parsedBytes += position;
+            if (!flush(client)) return false;
+            if (position == 0 || client.out.size() >= outputLimit) break;
+        }
+
+        // A closed peer is let go once every answer has been written
+        return !client.finished || !client.out.empty();
+    }
+
+    void answer(std::string& out, uint32_t id, uint32_t machine, uint32_t budget, const char* text, uint32_t length) {
+        using namespace MatcherProtocol;
+        if (machine == statsMachine) {
+            std::string reportText = histogram.format();
+            appendValue(out, id);
+            appendValue(out, report);
+            appendValue(out, reportText.size());
+            out += reportText;
+            return;
+        }
+
+        uint32_t status;
+        if (machine >= machines.size()) {
+            status = unknownMachine;
+        } else {
+            status = run(machines[machine], budget, text, length);
+        }
+        appendValue(out, id);
+        appendValue(out, status);
+        appendValue(out, 0);
+    }
+
+    // Same rules as the simulators: blanks and newlines are skipped
+    static uint32_t run(const Machine& machine, uint32_t budget, const char* text, uint32_t length) {
+        int current = 0;
+        uint32_t steps = 0;
+        for (uint32_t i = 0; i < length; i++) {
+            char ch = text[i];
+            if (ch == '\n' || ch == ' ') continue;
+            int symbol = machine.symbolMap[(unsigned char) ch];
+            if (symbol < 0) return MatcherProtocol::invalidSymbol;
+            if (++steps > budget) return MatcherProtocol::budgetExceeded;
+            current = machine.dfsm.next(current, symbol);
+        }
+        return machine.dfsm.accepting[current] ? MatcherProtocol::accepted : MatcherProtocol::rejected;
+    }
+
+    bool flush(Client& client) {
+        size_t written = 0;
+        while (written < client.out.size()) {
+            ssize_t count = write(client.fd, client.out.data() + written, client.out.size() - written);
+            if (count > 0) {
+                written += count;
+                continue;
+            }
+            if (count < 0 && errno == EINTR) continue;
+            if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            return false;
+        }
+        client.out.erase(0, written);
+        client.sentBytes += written;
+        sent += written;
+
+        // Answers written in full complete their requests
+        Clock::time_point now = Clock::now();
+        while (!client.pending.empty() && client.pending.front().offset <= client.sentBytes) {
+            histogram.add(std::chrono::duration_cast<std::chrono::nanoseconds>(now - client.pending.front().time).count());
+            client.pending.pop_front();
+        }
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,52 @@
+// MinimizeDFSM Program
+// Reads a DFSM file, merges equivalent states and drops unreachable ones
+// (Hopcroft's algorithm), and writes the minimal DFSM.
+//
+// HOW TO RUN THE CODE:
+// >>g++ -std=c++17 -O2 -o MinimizeDFSM MinimizeDFSM.cpp
+// >>./MinimizeDFSM [--stats] DFSM.txt MINIMAL.txt
+
+#include <iostream>
+#include <string>
+#include <chrono>
+
+#include "DFSM.h"
+#include "DFSMMinimizer.h"
+#include "Stats.h"
+
+int main(int argc, char* argv[]) {
+    bool wantStats = Stats::takeFlag(argc, argv);
+    Stats stats("MinimizeDFSM");
+    Stats* statsOut = wantStats ? &stats : nullptr;
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " [--stats] <input DFSM file> <output DFSM file>" << std::endl;
+        return 1;
+    }
+
+    try {
+        DFSM dfsm;
+        Stats::Stage read(statsOut, "read_dfsm");
+        read.addBytes(Stats::fileBytes(argv[1]));
+        dfsm.readFromFile(argv[1]);
+        read.stop();
+
+        auto start = std::chrono::steady_clock::now();
+        Stats::Stage minimize(statsOut, "minimize");
+        DFSM minimal = DFSMMinimizer::minimize(dfsm);
+        minimize.stop();
+        double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        Stats::Stage write(statsOut, "write_dfsm");
+        minimal.writeToFile(argv[2]);
+        write.stop();
+        stats.set("dfa_states", dfsm.numStates);
+        stats.set("minimal_dfa_states", minimal.numStates);
+        std::cout << "Minimized " << dfsm.numStates << " states to " << minimal.numStates << " ("
+                  << 100.0 * minimal.numStates / dfsm.numStates << "%) in " << milliseconds << " ms" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    if (wantStats) stats.report();
+    return 0;
+}
@@ -0,0 +1,134 @@
+// MinimizerTest Program
+// Checks DFSMMinimizer::minimize on random DFSMs: the minimal DFSM must
+// accept the same strings and report the same match IDs, be equivalent by
+// DFSMEquivalence, have as many states as a plain Moore refinement finds,
+// and come out identical for any numbering of the input states.
+//
+// HOW TO RUN THE CODE:
+// >>g++ -std=c++17 -O2 -o MinimizerTest MinimizerTest.cpp
+// >>./MinimizerTest
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#include "DFSMMinimizer.h"
+#include "DFSMEquivalence.h"
+#include "TestMachines.h"
+#include "TestCheck.h"
+
+// Moore's refinement over the reachable states: classes start from
+// acceptance and match IDs and split on the classes of the successors
+static int mooreStates(const DFSM& dfsm) {
+    int n = dfsm.numStates, k = dfsm.numSymbols();
+    std::vector<char> reachable(n, 0);
+    std::vector<int> stack(1, 0);
+    reachable[0] = 1;
+    while (!stack.empty()) {
+        int q = stack.back();
+        stack.pop_back();
+        for (int s = 0; s < k; s++) {
+            int t = dfsm.next(q, s);
+            if (!reachable[t]) {
+                reachable[t] = 1;
+                stack.push_back(t);
+            }
+        }
+    }
+
+    std::vector<int> block(n);
+    std::map<std::vector<int>, int> initial;
+    for (int q = 0; q < n; q++) {
+        std::vector<int> key(1, dfsm.accepting[q]);
+        if (dfsm.hasMatchIds()) key.insert(key.end(), dfsm.matchIds.begin() + dfsm.matchOffsets[q], dfsm.matchIds.begin() + dfsm.matchOffsets[q + 1]);
+        block[q] = initial.emplace(key, initial.size()).first->second;
+    }
+    for (size_t count = 0;;) {
+        std::map<std::vector<int>, int> signatures;
+        std::vector<int> refined(n);
+        for (int q = 0; q < n; q++) {
+            std::vector<int> key(1, block[q]);
+            for (int s = 0; s < k; s++) key.push_back(block[dfsm.next(q, s)]);
+            refined[q] = signatures.emplace(key, signatures.size()).first->second;
+        }
+        block.swap(refined);
+        if (signatures.size() == count) break;
+        count = signatures.size();
+    }
+
+    std::vector<int> used;
+    for (int q = 0; q < n; q++) {
+        if (reachable[q]) used.push_back(block[q]);
+    }
+    std::sort(used.begin(), used.end());
+    return std::unique(used.begin(), used.end()) - used.begin();
+}
+
+// Copy with the states other than the start renumbered at random
+static DFSM permuted(const DFSM& dfsm, std::mt19937& random) {
+    int n = dfsm.numStates, k = dfsm.numSymbols();
+    std::vector<int> order(n);
+    for (int q = 0; q < n; q++) order[q] = q;
+    std::shuffle(order.begin() + 1, order.end(), random);
+    DFSM copy = dfsm;
+    for (int q = 0; q < n; q++) {
+        for (int s = 0; s < k; s++) copy.transitions[(size_t) order[q] * k + s] = order[dfsm.next(q, s)];
+        copy.accepting[order[q]] = dfsm.accepting[q];
+    }
+    if (dfsm.hasMatchIds()) {
+        std::vector<std::vector<int>> ids(n);
+        for (int q = 0; q < n; q++) {
+            ids[order[q]].assign(dfsm.matchIds.begin() + dfsm.matchOffsets[q], dfsm.matchIds.begin() + dfsm.matchOffsets[q + 1]);
+        }
+        copy.setMatchIds(ids);
+    }
+    return copy;
+}
+
+static std::vector<int> idsAfter(const DFSM& dfsm, const std::string& text) {
+    int state = 0;
+    for (char c : text) state = dfsm.next(state, c - 'a');
+    return std::vector<int>(dfsm.matchIds.begin() + dfsm.matchOffsets[state], dfsm.matchIds.begin() + dfsm.matchOffsets[state + 1]);
+}
+
+int main() {
+    TestCheck check("MinimizerTest");
+    std::mt19937 random(35);
+
+    for (int round = 0; round < 400; round++) {
+        int states = 1 + random() % 30;
+        int symbols = 1 + random() % 3;
+        DFSM dfsm = TestMachines::randomDFSM(random, states, symbols);
+        bool withIds = round % 4 == 0;
+        if (withIds) {
+            std::vector<std::vector<int>> ids(states);
+            for (int q = 0; q < states; q++) {
+                if (dfsm.accepting[q] && random() % 2) ids[q].push_back(random() % 3);
+            }
+            dfsm.setMatchIds(ids);
+        }
+        std::string name = "round " + std::to_string(round);
+
+        DFSM minimal = DFSMMinimizer::minimize(dfsm);
+        for (const std::string& text : TestMachines::allStrings(symbols, 7)) {
+            check.expect(TestMachines::accepts(minimal, text) == TestMachines::accepts(dfsm, text), name + ": \"" + text + "\"");
+            if (withIds) check.expect(idsAfter(minimal, text) == idsAfter(dfsm, text), name + ": match IDs after \"" + text + "\"");
+        }
+        if (!withIds) {
+            check.expect(DFSMEquivalence::check(dfsm, minimal).equivalent, name + ": equivalent to the input");
+        }
+        check.expect(minimal.numStates == mooreStates(dfsm), name + ": " + std::to_string(minimal.numStates) +
+                     " states, Moore refinement finds " + std::to_string(mooreStates(dfsm)));
+
+        DFSM again = DFSMMinimizer::minimize(permuted(dfsm, random));
+        check.expect(again.transitions == minimal.transitions && again.accepting == minimal.accepting &&
+                     again.matchIds == minimal.matchIds, name + ": renumbered input gives the same DFSM");
+        DFSM twice = DFSMMinimizer::minimize(minimal);
+        check.expect(twice.transitions == minimal.transitions && twice.accepting == minimal.accepting,
+                     name + ": minimizing twice changes nothing");
+    }
+
+    return check.finish();
+}
@@ -0,0 +1,471 @@
+// NDFSM.h
+#ifndef NDFSM_H
+#define NDFSM_H
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <set>
+#include <map>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+
+#include "MappedFile.h"
+
+// In-memory NDFSM. States are 0-indexed here and 1-indexed in the file format.
+// The alphabet always ends with the epsilon symbol '$'.
+//
+// Two file layouts are accepted. The dense layout has one cell per symbol:
+//
+//     a b $
+//
+//     [1,2] [1] #
+//     ...
+//
+// The sparse layout starts with a "%sparse" line. Each row holds the default
+// cell, used for every non-epsilon symbol the row does not list, followed by
+// "symbol:cell" entries for the exceptions (epsilon included):
+//
+//     %sparse
+//     a b $
+//
+//     [1] a:[1,2]
+//     # b:[3] $:[4]
+//     ...
+//
+// Transitions are kept in compressed sparse rows. Every state owns a run of
+// cells in 'cellSymbols'/'cellOffsets': first its default cell, then its
+// explicit cells in symbol order, and last its epsilon cell. All target lists
+// are contiguous in 'targetStates'. Dense rows are compressed on load by
+// making the most common cell of the row its default.
+class NDFSM {
+public:
+    // Contiguous list of target states
+    struct Targets {
+        const int* first;
+        const int* last;
+        const int* begin() const { return first; }
+        const int* end() const { return last; }
+        size_t size() const { return last - first; }
+        bool empty() const { return first == last; }
+    };
+
+    std::vector<char> alphabet; // Alphabet including epsilon at the end
+    std::set<int> acceptingStates; // Accepting states of the NDFSM
+
+    std::vector<uint32_t> stateCells;  // numStates + 1 offsets into the cell arrays
+    std::vector<int> cellSymbols;      // Symbol index of each cell (-1 for the default cell)
+    std::vector<uint32_t> cellOffsets; // Cell count + 1 offsets into targetStates
+    std::vector<int> targetStates;
+
+    int numStates() const { return stateCells.empty() ? (int) pendingCells.size() : (int) stateCells.size() - 1; }
+    int numSymbols() const { return alphabet.size() - 1; } // Excluding epsilon
+    int epsilonIndex() const { return alphabet.size() - 1; }
+
+    int symbolIndex(char symbol) const {
+        if (symbolMap.empty()) {
+            for (int i = 0; i < numSymbols(); i++) {
+                if (alphabet[i] == symbol) return i;
+            }
+            return -1;
+        }
+        return symbolMap[(unsigned char) symbol];
+    }
+
+    Targets cellTargets(uint32_t cell) const {
+        return Targets{targetStates.data() + cellOffsets[cell], targetStates.data() + cellOffsets[cell + 1]};
+    }
+    Targets defaultTargets(int state) const { return cellTargets(stateCells[state]); }
+    Targets epsilonTargets(int state) const { return cellTargets(stateCells[state + 1] - 1); }
+
+    // Explicit cells of a state lie between its default and epsilon cells
+    uint32_t firstExplicitCell(int state) const { return stateCells[state] + 1; }
+    uint32_t endExplicitCell(int state) const { return stateCells[state + 1] - 1; }
+
+    Targets targets(int state, int symbol) const {
+        if (symbol == epsilonIndex()) return epsilonTargets(state);
+        const int* first = cellSymbols.data() + firstExplicitCell(state);
+        const int* last = cellSymbols.data() + endExplicitCell(state);
+        const int* found = std::lower_bound(first, last, symbol);
+        if (found != last && *found == symbol) return cellTargets(found - cellSymbols.data());
+        return defaultTargets(state);
+    }
+
+    // Construction: states and transitions are staged in ordered containers
+    // and packed into the compressed rows by finish()
+
+    int addState() {
+        pendingCells.emplace_back();
+        pendingDefaults.emplace_back();
+        return pendingCells.size() - 1;
+    }
+
+    void addTransition(int from, int symbolIndex, int to) {
+        auto it = pendingCells[from].find(symbolIndex);
+        if (it == pendingCells[from].end()) {
+            // An explicit cell replaces the default, so it starts from the default targets
+            std::set<int> cell = symbolIndex == epsilonIndex() ? std::set<int>() : pendingDefaults[from];
+            it = pendingCells[from].emplace(symbolIndex, cell).first;
+        }
+        it->second.insert(to);
+    }
+
+    void addDefaultTransition(int from, int to) {
+        pendingDefaults[from].insert(to);
+        for (auto& cell : pendingCells[from]) {
+            if (cell.first != epsilonIndex()) cell.second.insert(to);
+        }
+    }
+
+    void finish() {
+        std::vector<int> explicitSymbols;
+        std::vector<std::vector<int>> explicitTargets;
+        for (size_t state = 0; state < pendingCells.size(); state++) {
+            explicitSymbols.clear();
+            explicitTargets.clear();
+            std::vector<int> epsilon;
+            for (const auto& cell : pendingCells[state]) {
+                if (cell.first == epsilonIndex()) {
+                    epsilon.assign(cell.second.begin(), cell.second.end());
+                } else if (cell.second != pendingDefaults[state]) {
+                    explicitSymbols.push_back(cell.first);
+                    explicitTargets.emplace_back(cell.second.begin(), cell.second.end());
+                }
+            }
+            std::vector<int> defaults(pendingDefaults[state].begin(), pendingDefaults[state].end());
+            appendState(defaults, explicitSymbols, explicitTargets, epsilon);
+        }
+        pendingCells.clear();
+        pendingDefaults.clear();
+        finishLoad();
+    }
+
+    void readFromFile(const std::string& filename) {
+        MappedFile file(filename);
+        const char* p = file.data();
+        const char* end = p + file.size();
+
+        int section = 0;
+        bool sparse = false;
+        std::vector<int> rowSymbols;
+        std::vector<std::vector<int>> rowTargets;
+        std::vector<int> defaults, epsilon;
+
+        // Read lines into sections based on empty lines
+        while (p < end) {
+            const char* lineEnd = static_cast<const char*>(memchr(p, '\n', end - p));
+            if (!lineEnd) lineEnd = end;
+            const char* next = lineEnd < end ? lineEnd + 1 : end;
+            if (lineEnd > p && lineEnd[-1] == '\r') lineEnd--;
+
+            if (lineEnd == p) {
+                section++;
+            } else if (section == 0 && alphabet.empty() && std::string(p, lineEnd) == "%sparse") {
+                sparse = true;
+            } else if (section == 0) { // Alphabet section
+                parseAlphabet(p, lineEnd);
+            } else if (section == 1) { // Transitions section
+                if (sparse) {
+                    parseSparseTransitions(p, lineEnd, rowSymbols, rowTargets, defaults, epsilon);
+                } else {
+                    parseTransitions(p, lineEnd, rowSymbols, rowTargets, defaults, epsilon);
+                }
+            } else if (section == 2) { // Accepting states section
+                parseAcceptingStates(p, lineEnd);
+            }
+            p = next;
+        }
+
+        for (int target : targetStates) {
+            if (target < 0 || target >= numStates()) {
+                throw std::runtime_error("Invalid state number " + std::to_string(target + 1) + " in " + filename);
+            }
+        }
+        finishLoad();
+    }
+
+    static void writeCell(std::string& out, Targets cell) {
+        if (cell.empty()) {
+            out += '#';
+            return;
+        }
+        out += '[';
+        for (const int* t = cell.begin(); t != cell.end(); t++) {
+            if (t != cell.begin()) out += ',';
+            out += std::to_string(*t + 1);
+        }
+        out += ']';
+    }
+
+    void writeToFile(const std::string& filename, bool sparse = false) const {
+        std::ofstream writer(filename, std::ios::binary);
+        if (!writer) {
+            throw std::runtime_error("Could not open output file: " + filename);
+        }
+
+        std::string out = sparse ? "%sparse\n" : "";
+        for (char symbol : alphabet) {
+            out += symbol;
+            out += ' ';
+        }
+        out += "\n\n";
+
+        for (int state = 0; state < numStates(); state++) {
+            if (sparse) {
+                writeCell(out, defaultTargets(state));
+                for (uint32_t cell = firstExplicitCell(state); cell < endExplicitCell(state); cell++) {
+                    out += ' ';
+                    out += alphabet[cellSymbols[cell]];
+                    out += ':';
+                    writeCell(out, cellTargets(cell));
+                }
+                if (!epsilonTargets(state).empty()) {
+                    out += " $:";
+                    writeCell(out, epsilonTargets(state));
+                }
+            } else {
+                for (int symbol = 0; symbol < (int) alphabet.size(); symbol++) {
+                    writeCell(out, targets(state, symbol));
+                    out += ' ';
+                }
+            }
+            out += '\n';
+            if (out.size() >= (1 << 20)) {
+                writer.write(out.data(), out.size());
+                out.clear();
+            }
+        }
+        out += '\n';
+
+        for (int state : acceptingStates) {
+            out += std::to_string(state + 1);
+            out += ' ';
+        }
+        out += '\n';
+        writer.write(out.data(), out.size());
+    }
+
+    void print() const {
+        std::cout << "NDFSM Alphabet: ";
+        for (char c : alphabet) {
+            std::cout << c << " ";
+        }
+        std::cout << std::endl;
+
+        std::cout << "Transition Table:" << std::endl;
+        for (int state = 0; state < numStates(); ++state) {
+            for (size_t symbol = 0; symbol < alphabet.size(); ++symbol) {
+                std::cout << "State " << (state + 1) << " via " << alphabet[symbol] << " -> {";
+                for (int nextState : targets(state, symbol)) {
+                    std::cout << (nextState + 1) << " ";
+                }
+                std::cout << "} ";
+            }
+            std::cout << std::endl;
+        }
+
+        std::cout << "Accepting States: ";
+        for (int state : acceptingStates) {
+            std::cout << (state + 1) << " ";
+        }
+        std::cout << std::endl;
+    }
+
+private:
+    std::vector<int> symbolMap; // Symbol index by byte value, -1 for '$' and bytes outside the alphabet
+    std::vector<std::map<int, std::set<int>>> pendingCells;
+    std::vector<std::set<int>> pendingDefaults;
+
+    void appendState(const std::vector<int>& defaults, const std::vector<int>& symbols,
+                     const std::vector<std::vector<int>>& cells, const std::vector<int>& epsilon) {
+        if (stateCells.empty()) {
+            stateCells.push_back(0);
+            cellOffsets.push_back(0);
+        }
+        auto appendCell = [&](int symbol, const std::vector<int>& targets) {
+            cellSymbols.push_back(symbol);
+            targetStates.insert(targetStates.end(), targets.begin(), targets.end());
+            cellOffsets.push_back(targetStates.size());
+        };
+        appendCell(-1, defaults);
+        for (size_t i = 0; i < symbols.size(); i++) {
+            appendCell(symbols[i], cells[i]);
+        }
+        appendCell(epsilonIndex(), epsilon);
+        stateCells.push_back(cellSymbols.size());
+    }
+
+    void finishLoad() {
+        if (stateCells.empty()) {
+            stateCells.push_back(0);
+            cellOffsets.push_back(0);
+        }
+        symbolMap.assign(256, -1);
+        for (int i = 0; i < numSymbols(); i++) {
+            symbolMap[(unsigned char) alphabet[i]] = i;
+        }
+        for (int state : acceptingStates) {
+            if (state < 0 || state >= numStates()) {
+                throw std::runtime_error("Invalid accepting state number " + std::to_string(state + 1));
+            }
+        }
+    }
+
+    static void skipSpaces(const char*& p, const char* end) {
+        while (p < end && (*p == ' ' || *p == '\t')) p++;
+    }
+
+    // Reads the digits at p as a 1-indexed state number
+    static int parseStateNumber(const char*& p, const char* end) {
+        int64_t state = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            state = state * 10 + (*p++ - '0');
+            if (state > INT_MAX) {
+                throw std::runtime_error("State number is too large");
+            }
+        }
+        return state;
+    }
+
+    // Parses "[1,2]" or "#" at p into 0-indexed targets
+    static void parseCell(const char*& p, const char* end, std::vector<int>& targets) {
+        targets.clear();
+        if (p < end && *p == '#') {
+            p++;
+            return;
+        }
+        if (p >= end || *p != '[') {
+            throw std::runtime_error("Invalid transition cell \"" + std::string(p, std::find(p, end, ' ')) + "\"");
+        }
+        p++;
+        while (p < end && *p != ']') {
+            if (p >= end || *p < '0' || *p > '9') {
+                throw std::runtime_error("Invalid state list in transition cell");
+            }
+            int state = parseStateNumber(p, end);
+            targets.push_back(state - 1);
+            if (p < end && *p == ',') p++;
+        }
+        if (p >= end) {
+            throw std::runtime_error("Missing ']' in transition cell");
+        }
+        p++;
+        std::sort(targets.begin(), targets.end());
+        targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+    }
+
+    void parseAlphabet(const char* p, const char* end) {
+        for (; p < end; p++) {
+            if (*p != ' ' && *p != '\t') alphabet.push_back(*p);
+        }
+        if (alphabet.empty() || alphabet.back() != '$') {
+            throw std::runtime_error("Alphabet must end with the epsilon symbol '$'");
+        }
+        symbolMap.assign(256, -1);
+        for (int i = 0; i < numSymbols(); i++) {
+            symbolMap[(unsigned char) alphabet[i]] = i;
+        }
+    }
+
+    void parseTransitions(const char* p, const char* end, std::vector<int>& symbols,
+                          std::vector<std::vector<int>>& cells, std::vector<int>& defaults, std::vector<int>& epsilon) {
+        int row = numStates() + 1;
+        size_t k = alphabet.size();
+        if (cells.size() < k) cells.resize(k);
+
+        size_t count = 0;
+        skipSpaces(p, end);
+        while (p < end) {
+            if (count >= k) {
+                throw std::runtime_error("More transitions than alphabet symbols in row " + std::to_string(row));
+            }
+            parseCell(p, end, count + 1 == k ? epsilon : cells[count]);
+            count++;
+            skipSpaces(p, end);
+        }
+        if (count != k) {
+            throw std::runtime_error("The number of transitions does not match the number of alphabet symbols in row " + std::to_string(row));
+        }
+
+        // The most common cell becomes the default; sort cell indices so equal cells are adjacent
+        std::vector<int> order(k - 1);
+        for (size_t i = 0; i < k - 1; i++) order[i] = i;
+        std::sort(order.begin(), order.end(), [&](int a, int b) { return cells[a] < cells[b]; });
+        size_t bestStart = 0, bestLength = 0;
+        for (size_t i = 0; i < order.size();) {
+            size_t j = i;
+            while (j < order.size() && cells[order[j]] == cells[order[i]]) j++;
+            if (j - i > bestLength) {
+                bestStart = i;
+                bestLength = j - i;
+            }
+            i = j;
+        }
+        defaults.clear();
+        if (bestLength > 0) defaults = cells[order[bestStart]];
+
+        symbols.clear();
+        std::vector<std::vector<int>> explicitCells;
+        for (size_t i = 0; i < k - 1; i++) {
+            if (cells[i] != defaults) {
+                symbols.push_back(i);
+                explicitCells.push_back(cells[i]);
+            }
+        }
+        appendState(defaults, symbols, explicitCells, epsilon);
+    }
+
+    void parseSparseTransitions(const char* p, const char* end, std::vector<int>& symbols,
+                                std::vector<std::vector<int>>& cells, std::vector<int>& defaults, std::vector<int>& epsilon) {
+        int row = numStates() + 1;
+        symbols.clear();
+        epsilon.clear();
+        std::vector<std::pair<int, int>> order; // (symbol, cell slot)
+
+        skipSpaces(p, end);
+        parseCell(p, end, defaults);
+        skipSpaces(p, end);
+        size_t used = 0;
+        while (p < end) {
+            int symbol = end - p > 2 && p[1] == ':' ? (*p == '$' ? epsilonIndex() : symbolIndex(*p)) : -1;
+            if (symbol < 0) {
+                throw std::runtime_error("Invalid sparse transition \"" + std::string(p, std::find(p, end, ' ')) + "\" in row " + std::to_string(row));
+            }
+            p += 2;
+            if (symbol == epsilonIndex()) {
+                parseCell(p, end, epsilon);
+            } else {
+                if (cells.size() <= used) cells.resize(used + 1);
+                parseCell(p, end, cells[used]);
+                order.emplace_back(symbol, used++);
+            }
+            skipSpaces(p, end);
+        }
+
+        std::sort(order.begin(), order.end());
+        std::vector<std::vector<int>> explicitCells;
+        for (const auto& entry : order) {
+            if (!symbols.empty() && symbols.back() == entry.first) {
+                throw std::runtime_error("Symbol listed twice in row " + std::to_string(row));
+            }
+            symbols.push_back(entry.first);
+            explicitCells.push_back(cells[entry.second]);
+        }
+        appendState(defaults, symbols, explicitCells, epsilon);
+    }
+
+    void parseAcceptingStates(const char* p, const char* end) {
+        while (p < end) {
+            while (p < end && (*p < '0' || *p > '9')) p++;
+            if (p >= end) break;
+            int state = parseStateNumber(p, end);
+            acceptingStates.insert(state - 1);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,370 @@
+// NDFSMBuilder.h
+#ifndef NDFSMBUILDER_H
+#define NDFSMBUILDER_H
+
+#include <iostream>
+#include <fstream>
+#include <set>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+#include "NDFSM.h"
+
+class NDFSMBuilder {
+public:
+    // Writes the machine to fileName; false, with the error printed, when
+    // nothing was written
+    static bool buildNDFSM(const std::string& fileName, const std::string& pattern) {
+        if (pattern.empty()) {
+            std::cout << "Error: Pattern is empty." << std::endl;
+            return false;
+        }
+        for (size_t i = 0; i < pattern.size(); i++) {
+            if (reservedSymbol(pattern[i])) {
+                std::cout << "Error: Pattern character '" << pattern[i] << "' at offset " << i << " cannot be an NDFSM symbol." << std::endl;
+                return false;
+            }
+        }
+
+        // Determine the alphabet from the unique characters in the pattern
+        std::set<char> alphabetSet(pattern.begin(), pattern.end());
+        std::vector<char> alphabet(alphabetSet.begin(), alphabetSet.end());
+
+        // Add epsilon ('$') to the alphabet and ensure it is the last symbol
+        alphabet.push_back('$');
+
+        // Number of states needed is pattern length + 1
+        int numStates = pattern.length() + 1;
+
+        // Open file for writing
+        std::ofstream writer(fileName);
+        if (!writer) {
+            std::cout << "Error writing NDFSM specification: could not open file " << fileName << std::endl;
+            return false;
+        }
+
+        // Section 1: Write the alphabet
+        for (char symbol : alphabet) {
+            writer << symbol << " ";
+        }
+        writer << "\n\n";  // Empty line to separate sections
+
+        // Section 2: Write the transition table
+        for (int i = 1; i <= numStates; ++i) {
+            for (size_t j = 0; j < alphabet.size() - 1; ++j) {  // Exclude epsilon for now
+                char symbol = alphabet[j];
+
+                if (i == 1) {
+                    // State 1: Stay in State 1 for any input or move to State 2 for the first character of the pattern
+                    if (symbol == pattern[0]) {
+                        writer << "[1,2] ";  // Stay in state 1 or move to state 2 on pattern start
+                    } else {
+                        writer << "[1] ";  // Stay in state 1 for non-pattern start characters
+                    }
+                } else if (i < numStates) {
+                    // Intermediate states: Transition to the next state on the correct character
+                    char currentChar = pattern[i - 1];
+                    if (symbol == currentChar) {
+                        writer << "[" << (i + 1) << "] ";  // Move to the next state
+                    } else {
+                        writer << "# ";  // No valid transition
+                    }
+                } else {
+                    // Final state: Stay in the final state for all inputs
+                    writer << "[" << numStates << "] ";
+                }
+            }
+
+            // Epsilon transition ('$') handling - always the last column
+            writer << "#\n";  // No epsilon transition for any states
+        }
+
+        writer << "\n";  // Empty line to separate sections
+
+        // Section 3: Write the accepting states
+        writer << numStates << std::endl; // Accepting state is the last state
+
+        writer.close();
+        if (!writer) {
+            std::cout << "Error writing NDFSM specification: could not write file " << fileName << std::endl;
+            return false;
+        }
+        std::cout << "NDFSM specification written to " << fileName << std::endl;
+        return true;
+    }
+
+    // Builds the same machine in memory, for callers that do not need the file
+    static NDFSM build(const std::string& pattern) {
+        if (pattern.empty()) {
+            throw std::runtime_error("Pattern is empty");
+        }
+        for (char c : pattern) {
+            if (isspace((unsigned char) c) || c == '$') {
+                throw std::runtime_error(std::string("Pattern character '") + c + "' cannot be an NDFSM symbol");
+            }
+        }
+
+        NDFSM ndfsm;
+        std::set<char> alphabetSet(pattern.begin(), pattern.end());
+        ndfsm.alphabet.assign(alphabetSet.begin(), alphabetSet.end());
+        ndfsm.alphabet.push_back('$');
+
+        int numStates = pattern.length() + 1;
+        for (int i = 0; i < numStates; i++) {
+            ndfsm.addState();
+        }
+        ndfsm.addDefaultTransition(0, 0);
+        ndfsm.addTransition(0, ndfsm.symbolIndex(pattern[0]), 1);
+        for (int i = 1; i < numStates - 1; i++) {
+            ndfsm.addTransition(i, ndfsm.symbolIndex(pattern[i]), i + 1);
+        }
+        ndfsm.addDefaultTransition(numStates - 1, numStates - 1);
+        ndfsm.acceptingStates.insert(numStates - 1);
+        ndfsm.finish();
+        return ndfsm;
+    }
+
+    // Levenshtein machine: accepts any string containing a substring within
+    // 'errors' insertions, deletions or substitutions of the pattern. State
+    // e * (m + 1) + i means i pattern characters done with e errors. A pattern
+    // character moves to i + 1, any symbol to i + 1 with one more error
+    // (substitution) or to i with one more error (insertion), and epsilon to
+    // i + 1 with one more error (deletion). The alphabet defaults to the
+    // pattern's characters; the input's other characters need to be listed
+    // for them to count as substitutions and insertions.
+    static NDFSM buildApproximate(const std::string& pattern, int errors, const std::string& alphabetSymbols = "") {
+        if (pattern.empty()) {
+            throw std::runtime_error("Pattern is empty");
+        }
+        if (errors < 0) {
+            throw std::runtime_error("Number of errors must not be negative");
+        }
+        std::set<char> alphabetSet(pattern.begin(), pattern.end());
+        for (char c : alphabetSymbols) {
+            if (c != ' ' && c != ',') alphabetSet.insert(c);
+        }
+        for (char c : alphabetSet) {
+            if (reservedSymbol(c)) {
+                throw std::runtime_error(std::string("Character '") + c + "' cannot be an NDFSM symbol");
+            }
+        }
+
+        NDFSM ndfsm;
+        ndfsm.alphabet.assign(alphabetSet.begin(), alphabetSet.end());
+        ndfsm.alphabet.push_back('$');
+
+        int m = pattern.length(), row = m + 1;
+        for (int i = 0; i < row * (errors + 1); i++) {
+            ndfsm.addState();
+        }
+        ndfsm.addDefaultTransition(0, 0);
+        for (int e = 0; e <= errors; e++) {
+            for (int i = 0; i <= m; i++) {
+                int state = e * row + i;
+                if (i < m) {
+                    ndfsm.addTransition(state, ndfsm.symbolIndex(pattern[i]), state + 1);
+                }
+                if (e < errors) {
+                    if (i < m) {
+                        ndfsm.addDefaultTransition(state, state + row + 1);
+                        ndfsm.addTransition(state, ndfsm.epsilonIndex(), state + row + 1);
+                    }
+                    ndfsm.addDefaultTransition(state, state + row);
+                }
+            }
+            // A match with any number of errors stays found
+            ndfsm.addDefaultTransition(e * row + m, e * row + m);
+            ndfsm.acceptingStates.insert(e * row + m);
+        }
+        ndfsm.finish();
+        return ndfsm;
+    }
+
+    // Splits a wildcard pattern into the symbols each position accepts. A
+    // position is a literal character, '?' for any symbol, or a class such as
+    // [abc], [0-9] or [^xy]; '\' takes the next character literally. The
+    // alphabet is every character the pattern mentions, ranges included, plus
+    // 'alphabetSymbols'; '?' and negated classes are resolved against it.
+    static std::vector<std::set<char>> parseWildcards(const std::string& pattern, const std::string& alphabetSymbols,
+                                                      std::vector<char>& alphabet) {
+        struct Position {
+            std::set<char> symbols;
+            bool negated = false;
+            bool any = false;
+        };
+        std::vector<Position> positions;
+        std::set<char> alphabetSet;
+        for (char c : alphabetSymbols) {
+            if (c != ' ' && c != ',') alphabetSet.insert(c);
+        }
+
+        for (size_t i = 0; i < pattern.size(); i++) {
+            Position position;
+            char c = pattern[i];
+            if (c == '?') {
+                position.any = true;
+            } else if (c == '[') {
+                size_t j = i + 1;
+                if (j < pattern.size() && pattern[j] == '^') {
+                    position.negated = true;
+                    j++;
+                }
+                while (j < pattern.size() && pattern[j] != ']') {
+                    if (pattern[j] == '\\') j++;
+                    if (j >= pattern.size()) break;
+                    char low = pattern[j++], high = low;
+                    if (j + 1 < pattern.size() && pattern[j] == '-' && pattern[j + 1] != ']') {
+                        j++;
+                        if (pattern[j] == '\\' && j + 1 < pattern.size()) j++;
+                        high = pattern[j++];
+                        if ((unsigned char) high < (unsigned char) low) {
+                            throw std::runtime_error(std::string("Invalid range ") + low + "-" + high + " in pattern");
+                        }
+                    }
+                    for (int s = (unsigned char) low; s <= (unsigned char) high; s++) {
+                        position.symbols.insert((char) s);
+                    }
+                }
+                if (j >= pattern.size()) {
+                    throw std::runtime_error("Unterminated character class in pattern");
+                }
+                if (position.symbols.empty()) {
+                    throw std::runtime_error("Empty character class in pattern");
+                }
+                i = j;
+            } else {
+                if (c == '\\') {
+                    if (++i == pattern.size()) throw std::runtime_error("Pattern ends with '\\'");
+                    c = pattern[i];
+                }
+                position.symbols.insert(c);
+            }
+            alphabetSet.insert(position.symbols.begin(), position.symbols.end());
+            positions.push_back(position);
+        }
+        if (positions.empty()) {
+            throw std::runtime_error("Pattern is empty");
+        }
+        if (alphabetSet.empty()) {
+            throw std::runtime_error("The pattern uses no symbols; supply an alphabet");
+        }
+        for (char c : alphabetSet) {
+            if (reservedSymbol(c)) {
+                throw std::runtime_error(std::string("Character '") + c + "' cannot be an NDFSM symbol");
+            }
+        }
+
+        alphabet.assign(alphabetSet.begin(), alphabetSet.end());
+        std::vector<std::set<char>> classes;
+        for (const Position& position : positions) {
+            std::set<char> symbols;
+            for (char c : alphabet) {
+                bool listed = position.symbols.count(c) > 0;
+                if (position.any || listed != position.negated) symbols.insert(c);
+            }
+            if (symbols.empty()) {
+                throw std::runtime_error("A character class in the pattern matches no symbol of the alphabet");
+            }
+            classes.push_back(symbols);
+        }
+        return classes;
+    }
+
+    // The substring machine of a wildcard pattern: like build(), but position
+    // i moves to i + 1 on every symbol of its class
+    static NDFSM buildWildcard(const std::string& pattern, const std::string& alphabetSymbols = "") {
+        NDFSM ndfsm;
+        std::vector<std::set<char>> classes = parseWildcards(pattern, alphabetSymbols, ndfsm.alphabet);
+        ndfsm.alphabet.push_back('$');
+
+        int numStates = classes.size() + 1;
+        for (int i = 0; i < numStates; i++) {
+            ndfsm.addState();
+        }
+        ndfsm.addDefaultTransition(0, 0);
+        for (int i = 0; i < numStates - 1; i++) {
+            for (char c : classes[i]) {
+                ndfsm.addTransition(i, ndfsm.symbolIndex(c), i + 1);
+            }
+        }
+        ndfsm.addDefaultTransition(numStates - 1, numStates - 1);
+        ndfsm.acceptingStates.insert(numStates - 1);
+        ndfsm.finish();
+        return ndfsm;
+    }
+
+    // Writes the same machine in the sparse layout (see NDFSM.h): only the one
+    // pattern transition of each state is listed and everything else is the
+    // row default. Rows are streamed through a fixed-size buffer, so the file
+    // is O(length) and nothing but the pattern itself is held in memory.
+    // Like buildNDFSM, false when nothing was written.
+    static bool buildSparseNDFSM(const std::string& fileName, const char* pattern, size_t length) {
+        if (length == 0) {
+            std::cout << "Error: Pattern is empty." << std::endl;
+            return false;
+        }
+
+        bool used[256] = {false};
+        for (size_t i = 0; i < length; i++) {
+            if (reservedSymbol(pattern[i])) {
+                std::cout << "Error: Pattern character '" << pattern[i] << "' at offset " << i << " cannot be an NDFSM symbol." << std::endl;
+                return false;
+            }
+            used[(unsigned char) pattern[i]] = true;
+        }
+
+        std::ofstream writer(fileName, std::ios::binary);
+        if (!writer) {
+            std::cout << "Error writing NDFSM specification: could not open file " << fileName << std::endl;
+            return false;
+        }
+
+        std::string buffer = "%sparse\n";
+        for (int c = 0; c < 256; c++) {
+            if (used[c]) {
+                buffer += (char) c;
+                buffer += ' ';
+            }
+        }
+        buffer += "$ \n\n";
+
+        size_t numStates = length + 1;
+        buffer += "[1] ";
+        buffer += pattern[0];
+        buffer += ":[1,2]\n";
+        for (size_t i = 2; i < numStates; i++) {
+            buffer += "# ";
+            buffer += pattern[i - 1];
+            buffer += ":[";
+            buffer += std::to_string(i + 1);
+            buffer += "]\n";
+            if (buffer.size() >= (1 << 20)) {
+                writer.write(buffer.data(), buffer.size());
+                buffer.clear();
+            }
+        }
+        buffer += "[" + std::to_string(numStates) + "]\n\n";
+        buffer += std::to_string(numStates) + "\n";
+        writer.write(buffer.data(), buffer.size());
+
+        writer.close();
+        if (!writer) {
+            std::cout << "Error writing NDFSM specification: could not write file " << fileName << std::endl;
+            return false;
+        }
+        std::cout << "NDFSM specification written to " << fileName << std::endl;
+        return true;
+    }
+
+private:
+    // Characters the NDFSM file format gives a meaning of their own: blanks
+    // separate fields, '$' is epsilon and '#', '[' and ']' spell the cells
+    static bool reservedSymbol(char c) {
+        return isspace((unsigned char) c) || c == '$' || c == '#' || c == '[' || c == ']';
+    }
+};
+
+#endif
@@ -0,0 +1,411 @@
+// NDFSMtoDFSM.h
+#ifndef NDFSMTODFSM_H
+#define NDFSMTODFSM_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include "NDFSM.h"
+#include "DFSM.h"
+#include "EpsilonClosure.h"
+#include "Arena.h"
+#include "DFSMMinimizer.h"
+#include "FSMCache.h"
+#include "Stats.h"
+
+// Hash table that interns NDFSM state sets (sorted arrays of state numbers)
+// and hands out dense DFSM state IDs in insertion order. Open addressing keeps
+// the table a single array of IDs; the sets themselves are packed into an
+// arena, so interning a set costs no heap allocation of its own and the whole
+// table is released at once. A set's storage never moves while the table
+// grows, only clear() invalidates it.
+class StateSetTable {
+public:
+    // View of an interned set
+    struct StateSet {
+        const int* states;
+        int count;
+
+        const int* data() const { return states; }
+        size_t size() const { return count; }
+        const int* begin() const { return states; }
+        const int* end() const { return states + count; }
+    };
+
+    std::vector<StateSet> subsets;
+
+    explicit StateSetTable(size_t arenaBlockBytes = 256 << 10) : slots(1024, -1), sets(arenaBlockBytes) {}
+
+    static uint64_t hashStates(const int* states, size_t count) {
+        uint64_t h = 0x9E3779B97F4A7C15ULL ^ count;
+        for (size_t i = 0; i < count; i++) {
+            h ^= (uint32_t) states[i];
+            h *= 0xFF51AFD7ED558CCDULL;
+            h ^= h >> 32;
+        }
+        return h;
+    }
+
+    // Returns the ID of the set, adding it if unseen; 'added' reports which
+    int intern(const std::vector<int>& states, bool& added) {
+        return intern(states.data(), states.size(), hashStates(states.data(), states.size()), added);
+    }
+
+    int intern(const std::vector<int>& states, uint64_t h, bool& added) {
+        return intern(states.data(), states.size(), h, added);
+    }
+
+    int intern(const int* states, size_t count, uint64_t h, bool& added) {
+        size_t mask = slots.size() - 1;
+        for (size_t i = h & mask;; i = (i + 1) & mask) {
+            int id = slots[i];
+            if (id < 0) {
+                id = subsets.size();
+                slots[i] = id;
+                subsets.push_back({sets.copy(states, count), (int) count});
+                hashes.push_back(h);
+                added = true;
+                if (subsets.size() * 2 > slots.size()) grow();
+                return id;
+            }
+            if (same(id, states, count, h)) {
+                added = false;
+                return id;
+            }
+        }
+    }
+
+    // ID of the set, or -1; safe to call from several threads while nobody interns
+    int find(const std::vector<int>& states, uint64_t h) const {
+        size_t mask = slots.size() - 1;
+        for (size_t i = h & mask;; i = (i + 1) & mask) {
+            int id = slots[i];
+            if (id < 0) return -1;
+            if (same(id, states.data(), states.size(), h)) return id;
+        }
+    }
+
+    int size() const { return subsets.size(); }
+
+    // Bytes of set storage taken from the heap
+    size_t arenaBytes() const { return sets.reservedBytes(); }
+
+    void clear() {
+        subsets.clear();
+        hashes.clear();
+        sets.reset();
+        std::fill(slots.begin(), slots.end(), -1);
+    }
+
+private:
+    std::vector<int> slots;
+    std::vector<uint64_t> hashes;
+    Arena sets;
+
+    bool same(int id, const int* states, size_t count, uint64_t h) const {
+        return hashes[id] == h && (size_t) subsets[id].count == count &&
+               std::equal(states, states + count, subsets[id].states);
+    }
+
+    void grow() {
+        std::vector<int> bigger(slots.size() * 2, -1);
+        size_t mask = bigger.size() - 1;
+        for (size_t id = 0; id < subsets.size(); id++) {
+            size_t i = hashes[id] & mask;
+            while (bigger[i] >= 0) i = (i + 1) & mask;
+            bigger[i] = id;
+        }
+        slots.swap(bigger);
+    }
+};
+
+// Computes epsilon-closed successor sets. Successors without epsilon moves
+// are collected sparsely with a stamped mark array; once any closure row is
+// involved the whole move goes through a bitset, which yields the states
+// already sorted. The scratch arrays are reused between calls, so every
+// thread needs its own mover.
+class SubsetMover {
+public:
+    SubsetMover(const NDFSM& ndfsm, const EpsilonClosure& closures)
+        : ndfsm(ndfsm), closures(closures), mark(ndfsm.numStates(), 0), bits((ndfsm.numStates() + 63) / 64, 0) {}
+
+    // Sorted epsilon closure of the states reached from 'states' on 'symbol'
+    void move(const int* states, size_t count, int symbol, std::vector<int>& next) {
+        // After 2^32 moves the stamp wraps; stale marks must not match it
+        if (++stamp == 0) {
+            std::fill(mark.begin(), mark.end(), 0);
+            stamp = 1;
+        }
+        next.clear();
+        size_t lo = SIZE_MAX, hi = 0;
+        for (size_t i = 0; i < count; i++) {
+            for (int target : ndfsm.targets(states[i], symbol)) {
+                if (closures.hasRow(target)) {
+                    closures.orInto(target, bits.data(), lo, hi);
+                } else if (mark[target] != stamp) {
+                    mark[target] = stamp;
+                    next.push_back(target);
+                }
+            }
+        }
+        if (lo > hi) {
+            std::sort(next.begin(), next.end());
+            return;
+        }
+        for (int target : next) {
+            closures.orInto(target, bits.data(), lo, hi);
+        }
+        next.clear();
+        for (size_t w = lo; w <= hi; w++) {
+            uint64_t word = bits[w];
+            bits[w] = 0;
+            while (word) {
+                next.push_back(w * 64 + __builtin_ctzll(word));
+                word &= word - 1;
+            }
+        }
+    }
+
+private:
+    const NDFSM& ndfsm;
+    const EpsilonClosure& closures;
+    std::vector<unsigned> mark;
+    unsigned stamp = 0;
+    std::vector<uint64_t> bits;
+};
+
+class NDFSMtoDFSM {
+public:
+    // With a cache directory the DFSM is looked up by the NDFSM's content and
+    // the conversion options before anything is converted
+    static void convert(const std::string& inputFileName, const std::string& outputFileName, int threads = 1,
+                        bool minimize = false, const std::string& cacheDirectory = "", Stats* stats = nullptr) {
+        // The NDFSM reader accepts both the dense and the sparse layout
+        NDFSM ndfsm;
+        try {
+            Stats::Stage stage(stats, "read_ndfsm");
+            if (stats) stage.addBytes(Stats::fileBytes(inputFileName));
+            ndfsm.readFromFile(inputFileName);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            exit(1);
+        }
+
+        if (ndfsm.alphabet.empty() || ndfsm.numStates() == 0 || ndfsm.acceptingStates.empty()) {
+            std::cerr << "Error: Necessary sections are empty." << std::endl;
+            exit(1);
+        }
+
+        DFSM dfsm;
+        if (cacheDirectory.empty()) {
+            dfsm = convertToDFSM(ndfsm, threads, minimize, stats);
+        } else {
+            try {
+                FSMCache cache(cacheDirectory);
+                Stats::Stage lookup(stats, "cache_lookup");
+                std::string key = FSMCache::keyFor(ndfsm, minimize ? "minimized" : "subsets");
+                bool hit = cache.load(key, dfsm);
+                lookup.stop();
+                if (stats) stats->set("cache_hit", hit);
+                if (!hit) {
+                    dfsm = convertToDFSM(ndfsm, threads, minimize, stats);
+                    Stats::Stage store(stats, "cache_store");
+                    cache.store(key, dfsm);
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+                exit(1);
+            }
+        }
+        Stats::Stage stage(stats, "write_dfsm");
+        writeDFSM(dfsm, outputFileName);
+        if (stats) stage.addBytes(Stats::fileBytes(outputFileName));
+    }
+
+    static DFSM convertToDFSM(const NDFSM& ndfsm, int threads, bool minimize, Stats* stats = nullptr) {
+        DFSM dfsm = convertToDFSM(ndfsm, threads, stats);
+        if (!minimize) return dfsm;
+        Stats::Stage stage(stats, "minimize");
+        DFSM minimal = DFSMMinimizer::minimize(dfsm);
+        if (stats) stats->set("minimal_dfa_states", minimal.numStates);
+        return minimal;
+    }
+
+    // Subset construction over the reachable state sets only. DFSM state 1 is
+    // the epsilon closure of NDFSM state 1; the empty set, when reachable,
+    // becomes an ordinary dead state. With more than one thread the result is
+    // identical to the single-threaded one, state numbers included.
+    static DFSM convertToDFSM(const NDFSM& ndfsm, int threads = 1, Stats* stats = nullptr) {
+        Stats::Stage closureStage(stats, "epsilon_closure");
+        EpsilonClosure closures(ndfsm);
+        closureStage.stop();
+        Stats::Stage subsetStage(stats, "subset_construction");
+        int numSymbols = ndfsm.numSymbols();
+
+        DFSM dfsm;
+        dfsm.alphabet.assign(ndfsm.alphabet.begin(), ndfsm.alphabet.end() - 1); // Epsilon is not a DFSM symbol
+
+        StateSetTable table;
+        bool added;
+        table.intern(closures.closureOf(0), added);
+
+        if (threads > 1) {
+            convertParallel(ndfsm, closures, table, dfsm, threads);
+        } else {
+            SubsetMover mover(ndfsm, closures);
+            std::vector<int> next;
+
+            // IDs are handed out in discovery order, so processing them in order is a breadth-first walk
+            for (int current = 0; current < table.size(); current++) {
+                dfsm.addState();
+                for (int symbol = 0; symbol < numSymbols; symbol++) {
+                    StateSetTable::StateSet states = table.subsets[current];
+                    mover.move(states.data(), states.size(), symbol, next);
+                    dfsm.transitions[(size_t) current * numSymbols + symbol] = table.intern(next, added);
+                }
+            }
+        }
+
+        std::vector<char> isAccepting(ndfsm.numStates(), 0);
+        for (int state : ndfsm.acceptingStates) isAccepting[state] = 1;
+        for (int current = 0; current < table.size(); current++) {
+            for (int state : table.subsets[current]) {
+                if (isAccepting[state]) {
+                    dfsm.accepting[current] = 1;
+                    break;
+                }
+            }
+        }
+        if (stats) {
+            // Every DFSM state had one subset move per symbol
+            stats->set("nfa_states", ndfsm.numStates());
+            stats->set("closure_rows", closures.numRows());
+            stats->set("dfa_states", table.size());
+            stats->set("subsets_explored", (int64_t) table.size() * numSymbols);
+            stats->set("set_arena_bytes", table.arenaBytes());
+            stats->set("threads", threads);
+        }
+        return dfsm;
+    }
+
+    // Level-synchronous parallel construction. Workers expand the current
+    // frontier for every symbol and look the successors up in the main table,
+    // which is read-only while they run. Unseen sets are deduplicated in a
+    // lock-striped table that remembers the first (frontier position, symbol)
+    // producing each one; numbering them in that order afterwards reproduces
+    // the IDs of the single-threaded breadth-first walk.
+    static void convertParallel(const NDFSM& ndfsm, const EpsilonClosure& closures, StateSetTable& table, DFSM& dfsm, int threads) {
+        struct Shard {
+            std::mutex lock;
+            StateSetTable sets{16 << 10}; // Shards are rebuilt every level, so their blocks stay small
+            std::vector<uint64_t> firstPosition;
+            std::vector<int> ids;
+        };
+        const int numShards = 64;
+        const int chunk = 16;
+        size_t numSymbols = ndfsm.numSymbols();
+
+        std::vector<std::unique_ptr<SubsetMover>> movers;
+        for (int t = 0; t < threads; t++) {
+            movers.emplace_back(new SubsetMover(ndfsm, closures));
+        }
+
+        int levelStart = 0;
+        while (levelStart < table.size()) {
+            int levelEnd = table.size();
+            std::vector<int64_t> results((size_t) (levelEnd - levelStart) * numSymbols);
+            std::unique_ptr<Shard[]> shards(new Shard[numShards]);
+            std::atomic<int> nextState(levelStart);
+
+            auto worker = [&](SubsetMover& mover) {
+                std::vector<int> next;
+                for (;;) {
+                    int begin = nextState.fetch_add(chunk);
+                    if (begin >= levelEnd) break;
+                    int end = std::min(begin + chunk, levelEnd);
+                    for (int current = begin; current < end; current++) {
+                        StateSetTable::StateSet states = table.subsets[current];
+                        for (size_t symbol = 0; symbol < numSymbols; symbol++) {
+                            size_t position = (size_t) (current - levelStart) * numSymbols + symbol;
+                            mover.move(states.data(), states.size(), symbol, next);
+                            uint64_t h = StateSetTable::hashStates(next.data(), next.size());
+                            int id = table.find(next, h);
+                            if (id >= 0) {
+                                results[position] = id;
+                                continue;
+                            }
+                            int shardIndex = (h >> 32) % numShards;
+                            Shard& shard = shards[shardIndex];
+                            std::lock_guard<std::mutex> guard(shard.lock);
+                            bool added;
+                            int local = shard.sets.intern(next, h, added);
+                            if (added) {
+                                shard.firstPosition.push_back(position);
+                            } else if (position < shard.firstPosition[local]) {
+                                shard.firstPosition[local] = position;
+                            }
+                            results[position] = -1 - ((int64_t) local * numShards + shardIndex);
+                        }
+                    }
+                }
+            };
+
+            std::vector<std::thread> pool;
+            for (int t = 1; t < threads; t++) {
+                pool.emplace_back(worker, std::ref(*movers[t]));
+            }
+            worker(*movers[0]);
+            for (auto& thread : pool) thread.join();
+
+            // Number the new sets in order of first discovery
+            std::vector<std::pair<uint64_t, int64_t>> fresh;
+            for (int s = 0; s < numShards; s++) {
+                shards[s].ids.resize(shards[s].sets.size());
+                for (int local = 0; local < shards[s].sets.size(); local++) {
+                    fresh.emplace_back(shards[s].firstPosition[local], (int64_t) local * numShards + s);
+                }
+            }
+            std::sort(fresh.begin(), fresh.end());
+            for (const auto& entry : fresh) {
+                Shard& shard = shards[entry.second % numShards];
+                int local = entry.second / numShards;
+                bool added;
+                StateSetTable::StateSet states = shard.sets.subsets[local];
+                shard.ids[local] = table.intern(states.data(), states.size(),
+                                                StateSetTable::hashStates(states.data(), states.size()), added);
+            }
+
+            for (int current = levelStart; current < levelEnd; current++) {
+                dfsm.addState();
+                for (size_t symbol = 0; symbol < numSymbols; symbol++) {
+                    int64_t result = results[(size_t) (current - levelStart) * numSymbols + symbol];
+                    if (result < 0) {
+                        int64_t handle = -1 - result;
+                        result = shards[handle % numShards].ids[handle / numShards];
+                    }
+                    dfsm.transitions[(size_t) current * numSymbols + symbol] = result;
+                }
+            }
+            levelStart = levelEnd;
+        }
+    }
+
+    static void writeDFSM(const DFSM& dfsm, const std::string& fileName) {
+        try {
+            dfsm.writeToFile(fileName);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: Cannot write to output file: " << fileName << std::endl;
+            exit(1);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,59 @@
+// RegexToNDFSM Program
+// Compiles a regular expression into an NDFSM specification that the
+// NDFSMtoDFSM converter accepts.
+//
+// HOW TO RUN THE CODE:
+// >>g++ -std=c++17 -O2 -o RegexToNDFSM RegexToNDFSM.cpp
+// >>./RegexToNDFSM [--sparse] [-a <alphabet>] NFSM.txt "ab(c|d)*e"
+
+#include <iostream>
+#include <string>
+
+#include "RegexToNDFSM.h"
+#include "Stats.h"
+
+int main(int argc, char* argv[]) {
+    bool wantStats = Stats::takeFlag(argc, argv);
+    Stats stats("RegexToNDFSM");
+    Stats* statsOut = wantStats ? &stats : nullptr;
+    std::string alphabet;
+    bool sparse = false;
+    int arg = 1;
+    while (arg < argc && argv[arg][0] == '-') {
+        std::string option = argv[arg];
+        if (option == "-a" && arg + 1 < argc) {
+            alphabet = argv[arg + 1];
+            arg += 2;
+        } else if (option == "--sparse") {
+            sparse = true;
+            arg++;
+        } else {
+            break;
+        }
+    }
+    if (argc - arg != 2) {
+        std::cout << "Usage: " << argv[0] << " [--sparse] [-a <alphabet>] [--stats] <output_file> <regex>" << std::endl;
+        return 1;
+    }
+
+    std::string outputFileName = argv[arg];
+    std::string regex = argv[arg + 1];
+
+    try {
+        Stats::Stage compile(statsOut, "compile");
+        compile.addBytes(regex.size());
+        NDFSM ndfsm = RegexToNDFSM::compile(regex, alphabet);
+        compile.stop();
+        stats.set("nfa_states", ndfsm.numStates());
+        Stats::Stage write(statsOut, "write_ndfsm");
+        ndfsm.writeToFile(outputFileName, sparse);
+        write.stop();
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << "NDFSM specification written to " << outputFileName << std::endl;
+    if (wantStats) stats.report();
+    return 0;
+}
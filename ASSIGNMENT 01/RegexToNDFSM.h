@@ -0,0 +1,277 @@
+// RegexToNDFSM.h
+#ifndef REGEXTONDFSM_H
+#define REGEXTONDFSM_H
+
+#include <string>
+#include <vector>
+#include <set>
+#include <memory>
+#include <stdexcept>
+#include <cctype>
+
+#include "NDFSM.h"
+
+// Compiles a regular expression into the NDFSM file structure with a compact
+// Thompson construction. Epsilon moves go in the '$' column.
+//
+// Supported syntax: literals, '\' escapes, '.', [abc], [a-z], [^abc], grouping
+// with (), alternation |, and the postfix operators *, + and ?. A leading '^'
+// and a trailing '$' anchor the match; without them the machine accepts any
+// string that contains a match, like the NDFSMBuilder substring machines.
+class RegexToNDFSM {
+public:
+    static NDFSM compile(const std::string& regex, const std::string& alphabetSymbols = "") {
+        RegexToNDFSM compiler(regex);
+        return compiler.build(alphabetSymbols);
+    }
+
+private:
+    enum NodeType { SYMBOLS, CONCAT, ALTERNATE, STAR, PLUS, OPTIONAL, EMPTY };
+
+    struct Node {
+        NodeType type;
+        std::set<char> symbols;   // SYMBOLS: explicit symbols
+        bool negated = false;     // SYMBOLS: complement against the alphabet
+        bool any = false;         // SYMBOLS: '.'
+        std::vector<std::unique_ptr<Node>> children;
+        explicit Node(NodeType t) : type(t) {}
+    };
+
+    std::string regex;
+    size_t pos = 0;
+    bool anchoredStart = false;
+    bool anchoredEnd = false;
+    std::set<char> mentioned; // Symbols appearing anywhere in the expression
+    NDFSM ndfsm;
+
+    explicit RegexToNDFSM(const std::string& r) : regex(r) {}
+
+    NDFSM build(const std::string& alphabetSymbols) {
+        size_t end = regex.size();
+        if (!regex.empty() && regex[0] == '^') {
+            anchoredStart = true;
+            pos = 1;
+        }
+        if (end > pos && regex[end - 1] == '$' && !isEscaped(end - 1)) {
+            anchoredEnd = true;
+            regex.erase(end - 1);
+        }
+
+        std::unique_ptr<Node> root = parseAlternation();
+        if (pos != regex.size()) {
+            fail(regex[pos] == ')' ? "Unbalanced ')'" : "Unexpected character");
+        }
+
+        // The alphabet defaults to the symbols the expression mentions
+        std::set<char> symbols(mentioned);
+        if (!alphabetSymbols.empty()) {
+            symbols.clear();
+            for (char c : alphabetSymbols) {
+                if (c != ' ' && c != ',') symbols.insert(c);
+            }
+            for (char c : mentioned) {
+                if (!symbols.count(c)) {
+                    throw std::runtime_error(std::string("Symbol '") + c + "' is not in the given alphabet");
+                }
+            }
+        }
+        if (symbols.empty()) {
+            throw std::runtime_error("The expression uses no symbols; supply an alphabet");
+        }
+        for (char c : symbols) {
+            if (c == '$' || c == '#' || c == '[' || c == ']' || isspace((unsigned char) c)) {
+                throw std::runtime_error(std::string("Symbol '") + c + "' cannot be written in an NDFSM alphabet");
+            }
+            ndfsm.alphabet.push_back(c);
+        }
+        ndfsm.alphabet.push_back('$');
+
+        // State 1 is the start state; unanchored machines loop on it to skip a prefix
+        int start = ndfsm.addState();
+        if (!anchoredStart) {
+            addAllSymbols(start, start);
+        }
+
+        int last = emit(root.get(), start);
+        if (!anchoredEnd && !(last == start && !anchoredStart)) {
+            addAllSymbols(last, last);
+        }
+        ndfsm.acceptingStates.insert(last);
+        ndfsm.finish();
+        return ndfsm;
+    }
+
+    // Parsing
+
+    bool isEscaped(size_t index) const {
+        size_t backslashes = 0;
+        while (index > backslashes && regex[index - backslashes - 1] == '\\') backslashes++;
+        return backslashes % 2 == 1;
+    }
+
+    [[noreturn]] void fail(const std::string& message) const {
+        throw std::runtime_error(message + " at position " + std::to_string(pos + 1) + " in regular expression");
+    }
+
+    std::unique_ptr<Node> parseAlternation() {
+        std::unique_ptr<Node> first = parseConcatenation();
+        if (pos >= regex.size() || regex[pos] != '|') return first;
+
+        std::unique_ptr<Node> alt(new Node(ALTERNATE));
+        alt->children.push_back(std::move(first));
+        while (pos < regex.size() && regex[pos] == '|') {
+            pos++;
+            alt->children.push_back(parseConcatenation());
+        }
+        return alt;
+    }
+
+    std::unique_ptr<Node> parseConcatenation() {
+        std::unique_ptr<Node> concat(new Node(CONCAT));
+        while (pos < regex.size() && regex[pos] != '|' && regex[pos] != ')') {
+            concat->children.push_back(parseRepetition());
+        }
+        if (concat->children.empty()) return std::unique_ptr<Node>(new Node(EMPTY));
+        if (concat->children.size() == 1) return std::move(concat->children[0]);
+        return concat;
+    }
+
+    std::unique_ptr<Node> parseRepetition() {
+        std::unique_ptr<Node> atom = parseAtom();
+        while (pos < regex.size() && (regex[pos] == '*' || regex[pos] == '+' || regex[pos] == '?')) {
+            NodeType type = regex[pos] == '*' ? STAR : regex[pos] == '+' ? PLUS : OPTIONAL;
+            std::unique_ptr<Node> repeat(new Node(type));
+            repeat->children.push_back(std::move(atom));
+            atom = std::move(repeat);
+            pos++;
+        }
+        return atom;
+    }
+
+    std::unique_ptr<Node> parseAtom() {
+        char c = regex[pos];
+        if (c == '(') {
+            pos++;
+            std::unique_ptr<Node> inner = parseAlternation();
+            if (pos >= regex.size() || regex[pos] != ')') fail("Missing ')'");
+            pos++;
+            return inner;
+        }
+        if (c == '*' || c == '+' || c == '?') fail("Nothing to repeat");
+        if (c == '^' || c == '$') fail("Anchors are only allowed at the ends of the expression");
+
+        std::unique_ptr<Node> node(new Node(SYMBOLS));
+        if (c == '[') {
+            parseClass(*node);
+        } else if (c == '.') {
+            node->any = true;
+            pos++;
+        } else {
+            node->symbols.insert(parseLiteral());
+        }
+        return node;
+    }
+
+    char parseLiteral() {
+        if (regex[pos] == '\\') {
+            pos++;
+            if (pos >= regex.size()) fail("Trailing '\\'");
+        }
+        char c = regex[pos++];
+        mentioned.insert(c);
+        return c;
+    }
+
+    void parseClass(Node& node) {
+        pos++; // '['
+        if (pos < regex.size() && regex[pos] == '^') {
+            node.negated = true;
+            pos++;
+        }
+        bool first = true;
+        while (pos < regex.size() && (regex[pos] != ']' || first)) {
+            char low = parseLiteral();
+            if (pos + 1 < regex.size() && regex[pos] == '-' && regex[pos + 1] != ']') {
+                pos++;
+                char high = parseLiteral();
+                if (high < low) fail("Invalid character range");
+                for (int ch = low; ch <= high; ch++) {
+                    node.symbols.insert((char) ch);
+                    mentioned.insert((char) ch);
+                }
+            } else {
+                node.symbols.insert(low);
+            }
+            first = false;
+        }
+        if (pos >= regex.size()) fail("Missing ']'");
+        pos++; // ']'
+    }
+
+    // Construction. emit() adds the fragment for a node starting at state 'from'
+    // and returns its end state. Loops always go through a fresh state so that
+    // sibling fragments sharing 'from' cannot reach each other.
+
+    void addAllSymbols(int from, int to) {
+        for (int i = 0; i < ndfsm.numSymbols(); i++) {
+            ndfsm.addTransition(from, i, to);
+        }
+    }
+
+    void addEpsilon(int from, int to) {
+        if (from != to) ndfsm.addTransition(from, ndfsm.epsilonIndex(), to);
+    }
+
+    int emit(const Node* node, int from) {
+        switch (node->type) {
+            case EMPTY:
+                return from;
+            case SYMBOLS: {
+                int to = ndfsm.addState();
+                for (int i = 0; i < ndfsm.numSymbols(); i++) {
+                    char symbol = ndfsm.alphabet[i];
+                    bool listed = node->any || node->symbols.count(symbol);
+                    if (listed != node->negated) ndfsm.addTransition(from, i, to);
+                }
+                return to;
+            }
+            case CONCAT: {
+                int current = from;
+                for (const auto& child : node->children) {
+                    current = emit(child.get(), current);
+                }
+                return current;
+            }
+            case ALTERNATE: {
+                std::vector<int> ends;
+                for (const auto& child : node->children) {
+                    ends.push_back(emit(child.get(), from));
+                }
+                int join = ndfsm.addState();
+                for (int end : ends) addEpsilon(end, join);
+                return join;
+            }
+            case STAR: {
+                int loop = ndfsm.addState();
+                addEpsilon(from, loop);
+                addEpsilon(emit(node->children[0].get(), loop), loop);
+                return loop;
+            }
+            case PLUS: {
+                int loop = ndfsm.addState();
+                addEpsilon(from, loop);
+                int end = emit(node->children[0].get(), loop);
+                addEpsilon(end, loop);
+                return end;
+            }
+            case OPTIONAL: {
+                int end = emit(node->children[0].get(), from);
+                addEpsilon(from, end);
+                return end;
+            }
+        }
+        return from;
+    }
+};
+
+#endif
@@ -0,0 +1,68 @@
+// ReverseFSM.h
+#ifndef REVERSEFSM_H
+#define REVERSEFSM_H
+
+#include "NDFSM.h"
+#include "DFSM.h"
+
+// Builds an NDFSM for the reversed language of a machine: every transition
+// is turned around, a new start state moves on epsilon to the old accepting
+// states, and the old start state becomes the only accepting state. State 0
+// is the new start, old state q becomes state q + 1.
+//
+// With 'anyPrefix' the new start state also loops on every symbol, so the
+// machine accepts any string that ends in a reversed word. Run backwards over
+// a text, it is in an accepting state exactly at the positions where a word
+// of the original language starts.
+class ReverseFSM {
+public:
+    static NDFSM reverse(const NDFSM& ndfsm, bool anyPrefix = false) {
+        NDFSM reversed;
+        reversed.alphabet = ndfsm.alphabet;
+        start(reversed, ndfsm.numStates(), ndfsm.acceptingStates, anyPrefix);
+        int epsilon = ndfsm.epsilonIndex();
+        for (int state = 0; state < ndfsm.numStates(); state++) {
+            for (int symbol = 0; symbol < ndfsm.numSymbols(); symbol++) {
+                for (int target : ndfsm.targets(state, symbol)) {
+                    reversed.addTransition(target + 1, symbol, state + 1);
+                }
+            }
+            for (int target : ndfsm.epsilonTargets(state)) {
+                reversed.addTransition(target + 1, epsilon, state + 1);
+            }
+        }
+        reversed.finish();
+        return reversed;
+    }
+
+    static NDFSM reverse(const DFSM& dfsm, bool anyPrefix = false) {
+        NDFSM reversed;
+        reversed.alphabet = dfsm.alphabet;
+        reversed.alphabet.push_back('$');
+        std::set<int> accepting;
+        for (int state = 0; state < dfsm.numStates; state++) {
+            if (dfsm.accepting[state]) accepting.insert(state);
+        }
+        start(reversed, dfsm.numStates, accepting, anyPrefix);
+        for (int state = 0; state < dfsm.numStates; state++) {
+            for (int symbol = 0; symbol < dfsm.numSymbols(); symbol++) {
+                reversed.addTransition(dfsm.next(state, symbol) + 1, symbol, state + 1);
+            }
+        }
+        reversed.finish();
+        return reversed;
+    }
+
+private:
+    static void start(NDFSM& reversed, int numStates, const std::set<int>& accepting, bool anyPrefix) {
+        reversed.addState();
+        for (int state = 0; state < numStates; state++) reversed.addState();
+        for (int state : accepting) {
+            reversed.addTransition(0, reversed.epsilonIndex(), state + 1);
+        }
+        if (anyPrefix) reversed.addDefaultTransition(0, 0);
+        reversed.acceptingStates.insert(1);
+    }
+};
+
+#endif
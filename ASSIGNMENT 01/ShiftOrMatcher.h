@@ -0,0 +1,120 @@
+// ShiftOrMatcher.h
+#ifndef SHIFTORMATCHER_H
+#define SHIFTORMATCHER_H
+
+#include <vector>
+#include <set>
+#include <string>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+
+// Shift-Or run of a wildcard pattern (NDFSMBuilder::buildWildcard): bit i of
+// D is 0 while the last i + 1 symbols fit the first i + 1 positions, and a
+// step is D = (D << 1) | mask[c], where mask[c] has a 0 at every position
+// whose class holds c. Classes and wildcards cost nothing at run time, since
+// they are folded into the masks when the matcher is built. Patterns longer
+// than 64 positions carry the shift across words.
+class ShiftOrMatcher {
+public:
+    ShiftOrMatcher(const std::vector<std::set<char>>& classes, const std::vector<char>& alphabet)
+        : patternLength(classes.size()), words((classes.size() + 63) / 64) {
+        if (classes.empty()) {
+            throw std::runtime_error("Pattern is empty");
+        }
+        for (int b = 0; b < 256; b++) {
+            keep[b] = 0;
+            unknown[b] = b != '\n' && b != ' ';
+        }
+        for (char c : alphabet) {
+            if (c == '$') continue;
+            keep[(unsigned char) c] = 1;
+            unknown[(unsigned char) c] = 0;
+        }
+        masks.assign(256 * words, ~0ULL);
+        for (size_t i = 0; i < patternLength; i++) {
+            for (char c : classes[i]) {
+                masks[(unsigned char) c * words + i / 64] &= ~(1ULL << (i % 64));
+            }
+        }
+    }
+
+    size_t numWords() const { return words; }
+
+    // Runs the whole input like the DFSM simulators: blanks and newlines are
+    // skipped and any other byte outside the alphabet is an error
+    bool accepts(const char* text, size_t length) const {
+        size_t end = words == 1 ? runOneWord(text, length) : runWords(text, length);
+        if (end == length + 1) return false;
+
+        // Once a match is found the answer is fixed; the rest of the input is
+        // only checked against the alphabet
+        checkAlphabet(text + end, length - end);
+        return true;
+    }
+
+private:
+    static const size_t chunk = 4096;
+
+    size_t patternLength;
+    size_t words;
+    std::vector<uint64_t> masks; // 'words' words per byte value
+    uint8_t keep[256];           // 1 for alphabet bytes
+    uint8_t unknown[256];        // 1 for bytes that are neither symbols nor skipped
+
+    // Both runners return a position after the first match up to which the
+    // input has been checked, or length + 1 for no match
+
+    // Blanks take the old D back with a conditional move, so a byte is one
+    // shift and one OR with no branch; matches and alphabet errors are looked
+    // for once per chunk
+    size_t runOneWord(const char* text, size_t length) const {
+        uint64_t lastBit = 1ULL << (patternLength - 1);
+        uint64_t d = ~0ULL;
+        for (size_t start = 0; start < length; start += chunk) {
+            size_t end = std::min(start + chunk, length);
+            uint64_t seen = ~0ULL;
+            uint8_t bad = 0;
+            for (size_t i = start; i < end; i++) {
+                unsigned char ch = text[i];
+                uint64_t next = (d << 1) | masks[ch];
+                d = keep[ch] ? next : d;
+                seen &= d;
+                bad |= unknown[ch];
+            }
+            if (bad) checkAlphabet(text + start, end - start);
+            if (!(seen & lastBit)) return end;
+        }
+        return length + 1;
+    }
+
+    size_t runWords(const char* text, size_t length) const {
+        size_t last = patternLength - 1;
+        uint64_t lastBit = 1ULL << (last % 64);
+        std::vector<uint64_t> d(words, ~0ULL);
+        for (size_t i = 0; i < length; i++) {
+            unsigned char ch = text[i];
+            if (!keep[ch]) {
+                if (unknown[ch]) checkAlphabet(text + i, 1);
+                continue;
+            }
+            const uint64_t* mask = &masks[ch * words];
+            for (size_t w = words - 1; w > 0; w--) {
+                d[w] = ((d[w] << 1) | (d[w - 1] >> 63)) | mask[w];
+            }
+            d[0] = (d[0] << 1) | mask[0];
+            if (!(d[last / 64] & lastBit)) return i + 1;
+        }
+        return length + 1;
+    }
+
+    void checkAlphabet(const char* text, size_t length) const {
+        for (size_t i = 0; i < length; i++) {
+            if (unknown[(unsigned char) text[i]]) {
+                throw std::runtime_error(std::string("Character '") + text[i] + "' is not in the alphabet");
+            }
+        }
+    }
+};
+
+#endif
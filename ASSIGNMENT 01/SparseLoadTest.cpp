@@ -0,0 +1,100 @@
+// SparseLoadTest Program
+// Checks the compressed-row NDFSM storage and its two file layouts: random
+// NDFSMs written in the dense and the sparse layout must read back with the
+// same targets for every state and symbol, a hand-written sparse file must
+// load as documented in NDFSM.h, and malformed files must be rejected.
+//
+// HOW TO RUN THE CODE:
+// >>g++ -std=c++17 -O2 -o SparseLoadTest SparseLoadTest.cpp
+// >>./SparseLoadTest
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+
+#include "NDFSM.h"
+#include "TestMachines.h"
+#include "TestCheck.h"
+
+static const std::string fileName = "SparseLoadTest.tmp";
+
+static std::vector<int> list(NDFSM::Targets targets) {
+    return std::vector<int>(targets.begin(), targets.end());
+}
+
+static bool sameMachine(const NDFSM& a, const NDFSM& b) {
+    if (a.alphabet != b.alphabet || a.numStates() != b.numStates() || a.acceptingStates != b.acceptingStates) {
+        return false;
+    }
+    for (int q = 0; q < a.numStates(); q++) {
+        for (int symbol = 0; symbol <= a.epsilonIndex(); symbol++) {
+            if (list(a.targets(q, symbol)) != list(b.targets(q, symbol))) return false;
+        }
+    }
+    return true;
+}
+
+static NDFSM load(const std::string& text) {
+    std::ofstream(fileName, std::ios::binary) << text;
+    NDFSM ndfsm;
+    ndfsm.readFromFile(fileName);
+    return ndfsm;
+}
+
+static bool rejected(const std::string& text) {
+    try {
+        load(text);
+    } catch (const std::exception&) {
+        return true;
+    }
+    return false;
+}
+
+int main() {
+    TestCheck check("SparseLoadTest");
+    std::mt19937 random(31);
+
+    for (int round = 0; round < 300; round++) {
+        int states = 1 + random() % 15;
+        int symbols = 1 + random() % 5;
+        NDFSM ndfsm = TestMachines::randomNDFSM(random, states, symbols, 0.15, 0.1, 0.6);
+        std::string name = "round " + std::to_string(round);
+        for (bool sparse : {false, true}) {
+            ndfsm.writeToFile(fileName, sparse);
+            NDFSM loaded;
+            loaded.readFromFile(fileName);
+            check.expect(sameMachine(ndfsm, loaded), name + (sparse ? ": sparse" : ": dense") + " layout reads back");
+        }
+    }
+
+    // The example of NDFSM.h
+    NDFSM example = load("%sparse\na b $\n\n[1] a:[1,2]\n# b:[3] $:[4]\n[3]\n#\n\n4\n");
+    check.expect(example.numStates() == 4 && example.acceptingStates == std::set<int>{3}, "example: states and accepting");
+    check.expect(list(example.targets(0, 0)) == std::vector<int>{0, 1} && list(example.targets(0, 1)) == std::vector<int>{0},
+                 "example: row 1");
+    check.expect(list(example.targets(1, 0)).empty() && list(example.targets(1, 1)) == std::vector<int>{2} &&
+                 list(example.epsilonTargets(1)) == std::vector<int>{3}, "example: row 2");
+    check.expect(list(example.targets(2, 0)) == std::vector<int>{2} && list(example.targets(2, 1)) == std::vector<int>{2},
+                 "example: row 3 has only a default");
+
+    // A dense file holding the same machine loads the same
+    check.expect(sameMachine(example, load("a b $\n\n[1,2] [1] #\n# [3] [4]\n[3] [3] #\n# # #\n\n4\n")),
+                 "example: dense and sparse layouts agree");
+
+    check.expect(rejected("a b\n\n[1] [1]\n\n1\n"), "alphabet without '$'");
+    check.expect(rejected("a $\n\n[1] # #\n\n1\n"), "dense row with too many cells");
+    check.expect(rejected("a b $\n\n[1] #\n\n1\n"), "dense row with too few cells");
+    check.expect(rejected("a $\n\n[1,2 #\n[2] #\n\n2\n"), "cell without ']'");
+    check.expect(rejected("a $\n\n[1,x] #\n\n1\n"), "cell with a non-number");
+    check.expect(rejected("a $\n\n[3] #\n\n1\n"), "target past the last state");
+    check.expect(rejected("a $\n\n[1,4294967297] #\n\n1\n"), "target above INT_MAX");
+    check.expect(rejected("a $\n\n[1] #\n\n4294967297\n"), "accepting state above INT_MAX");
+    check.expect(rejected("a $\n\n[1] #\n\n2\n"), "accepting state past the last state");
+    check.expect(rejected("%sparse\na $\n\n[1] c:[1]\n\n1\n"), "sparse entry with an unknown symbol");
+    check.expect(rejected("%sparse\na b $\n\n# a:[1] a:[1]\n\n1\n"), "sparse row listing a symbol twice");
+
+    std::remove(fileName.c_str());
+    return check.finish();
+}
@@ -0,0 +1,218 @@
+// Stats.h
+#ifndef STATS_H
+#define STATS_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+// Telemetry for the --stats option of the tools. Stages record wall and CPU
+// time and optionally the bytes they processed; counters record sizes such as
+// state counts. report() prints one JSON object on stderr, keeping stdout
+// free for the tool's normal output.
+//
+// Code that takes a Stats pointer accepts nullptr, which records nothing.
+class Stats {
+public:
+    // Times a stage from construction to destruction (or to stop())
+    class Stage {
+    public:
+        Stage(Stats* stats, const char* name) : stats(stats), name(name) {
+            if (stats) {
+                wallStart = std::chrono::steady_clock::now();
+                cpuStart = cpuSeconds();
+            }
+        }
+
+        ~Stage() { stop(); }
+
+        Stage(const Stage&) = delete;
+        Stage& operator=(const Stage&) = delete;
+
+        void addBytes(uint64_t count) { bytes += count; }
+
+        void stop() {
+            if (!stats) return;
+            double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+            stats->addStage(name, wall, cpuSeconds() - cpuStart, bytes);
+            stats = nullptr;
+        }
+
+    private:
+        Stats* stats;
+        const char* name;
+        std::chrono::steady_clock::time_point wallStart;
+        double cpuStart = 0;
+        uint64_t bytes = 0;
+    };
+
+    explicit Stats(const std::string& tool) : tool(tool), wallStart(std::chrono::steady_clock::now()) {}
+
+    // Removes every "--stats" from the arguments; true if there was one
+    static bool takeFlag(int& argc, char* argv[]) {
+        bool found = false;
+        int kept = 1;
+        for (int i = 1; i < argc; i++) {
+            if (strcmp(argv[i], "--stats") == 0) {
+                found = true;
+            } else {
+                argv[kept++] = argv[i];
+            }
+        }
+        argc = kept;
+        argv[argc] = nullptr;
+        return found;
+    }
+
+    // Stages with the same name accumulate
+    void addStage(const std::string& name, double wall, double cpu, uint64_t bytes) {
+        for (StageTotal& stage : stages) {
+            if (stage.name == name) {
+                stage.wall += wall;
+                stage.cpu += cpu;
+                stage.bytes += bytes;
+                stage.count++;
+                return;
+            }
+        }
+        stages.push_back({name, wall, cpu, bytes, 1});
+    }
+
+    // Total wall time of a stage, 0 if it never ran
+    double stageSeconds(const std::string& name) const {
+        for (const StageTotal& stage : stages) {
+            if (stage.name == name) return stage.wall;
+        }
+        return 0;
+    }
+
+    void set(const std::string& name, int64_t value) {
+        for (auto& counter : counters) {
+            if (counter.first == name) {
+                counter.second = value;
+                return;
+            }
+        }
+        counters.emplace_back(name, value);
+    }
+
+    void add(const std::string& name, int64_t value) {
+        for (auto& counter : counters) {
+            if (counter.first == name) {
+                counter.second += value;
+                return;
+            }
+        }
+        counters.emplace_back(name, value);
+    }
+
+    std::string json() const {
+        std::string out = "{\"tool\": \"" + escape(tool) + "\", \"stages\": [";
+        for (size_t i = 0; i < stages.size(); i++) {
+            const StageTotal& stage = stages[i];
+            out += i ? ", " : "";
+            out += "{\"name\": \"" + escape(stage.name) + "\", \"count\": " + std::to_string(stage.count) +
+                   ", \"wall_seconds\": " + number(stage.wall) + ", \"cpu_seconds\": " + number(stage.cpu);
+            if (stage.bytes) {
+                out += ", \"bytes\": " + std::to_string(stage.bytes) +
+                       ", \"bytes_per_second\": " + number(stage.wall > 0 ? stage.bytes / stage.wall : 0);
+            }
+            out += "}";
+        }
+        out += "], \"counters\": {";
+        for (size_t i = 0; i < counters.size(); i++) {
+            out += i ? ", " : "";
+            out += "\"" + escape(counters[i].first) + "\": " + std::to_string(counters[i].second);
+        }
+        double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+        out += "}, \"wall_seconds\": " + number(wall) + ", \"cpu_seconds\": " + number(cpuSeconds()) +
+               ", \"peak_rss_bytes\": " + std::to_string(peakResidentBytes()) + "}";
+        return out;
+    }
+
+    void report() const {
+        std::cerr << json() << std::endl;
+    }
+
+    // CPU time of the whole process, all threads included
+    static double cpuSeconds() {
+#ifndef _WIN32
+        timespec now;
+        if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now) == 0) {
+            return now.tv_sec + now.tv_nsec * 1e-9;
+        }
+#endif
+        return (double) std::clock() / CLOCKS_PER_SEC;
+    }
+
+    // CPU time of the calling thread, for stages timed inside worker threads
+    static double threadCpuSeconds() {
+#ifndef _WIN32
+        timespec now;
+        if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now) == 0) {
+            return now.tv_sec + now.tv_nsec * 1e-9;
+        }
+#endif
+        return 0;
+    }
+
+    // Size of a file, or 0 if it cannot be read
+    static uint64_t fileBytes(const std::string& fileName) {
+        std::error_code error;
+        uint64_t size = std::filesystem::file_size(fileName, error);
+        return error ? 0 : size;
+    }
+
+    static uint64_t peakResidentBytes() {
+#ifndef _WIN32
+        rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+            return usage.ru_maxrss;
+#else
+            return (uint64_t) usage.ru_maxrss * 1024;
+#endif
+        }
+#endif
+        return 0;
+    }
+
+private:
+    struct StageTotal {
+        std::string name;
+        double wall, cpu;
+        uint64_t bytes;
+        int count;
+    };
+
+    std::string tool;
+    std::chrono::steady_clock::time_point wallStart;
+    std::vector<StageTotal> stages;
+    std::vector<std::pair<std::string, int64_t>> counters;
+
+    static std::string number(double value) {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%.6g", value);
+        return buffer;
+    }
+
+    static std::string escape(const std::string& text) {
+        std::string out;
+        for (char ch : text) {
+            if (ch == '"' || ch == '\\') out += '\\';
+            out += ch;
+        }
+        return out;
+    }
+};
+
+#endif
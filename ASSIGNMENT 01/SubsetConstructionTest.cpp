@@ -0,0 +1,60 @@
+// SubsetConstructionTest Program
+// Checks NDFSMtoDFSM::convertToDFSM on random NDFSMs with epsilon moves:
+// the DFSM must accept exactly the strings a direct set simulation of the
+// NDFSM accepts, and a threaded conversion must give the same table.
+//
+// HOW TO RUN THE CODE:
+// >>g++ -std=c++17 -O2 -pthread -o SubsetConstructionTest SubsetConstructionTest.cpp
+// >>./SubsetConstructionTest
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "NDFSMtoDFSM.h"
+#include "TestMachines.h"
+#include "TestCheck.h"
+
+int main() {
+    TestCheck check("SubsetConstructionTest");
+    std::mt19937 random(29);
+
+    for (int round = 0; round < 300; round++) {
+        int states = 1 + random() % 12;
+        int symbols = 1 + random() % 3;
+        double epsilon = round % 3 == 0 ? 0 : 0.15;
+        NDFSM ndfsm = TestMachines::randomNDFSM(random, states, symbols, 0.2, epsilon);
+        std::string name = "round " + std::to_string(round);
+
+        DFSM dfsm = NDFSMtoDFSM::convertToDFSM(ndfsm);
+        bool complete = dfsm.numStates > 0 && (int) dfsm.transitions.size() == dfsm.numStates * symbols;
+        for (int target : dfsm.transitions) complete = complete && target >= 0 && target < dfsm.numStates;
+        if (!check.expect(complete, name + ": DFSM table is complete")) continue;
+
+        for (const std::string& text : TestMachines::allStrings(symbols, 6)) {
+            check.expect(TestMachines::accepts(dfsm, text) == TestMachines::accepts(ndfsm, text),
+                         name + ": \"" + text + "\"");
+        }
+
+        DFSM threaded = NDFSMtoDFSM::convertToDFSM(ndfsm, 3);
+        check.expect(threaded.transitions == dfsm.transitions && threaded.accepting == dfsm.accepting,
+                     name + ": threaded conversion gives the same table");
+    }
+
+    // The n-th symbol from the end needs 2^n DFSM states
+    for (int n = 1; n <= 10; n++) {
+        NDFSM ndfsm;
+        ndfsm.alphabet = {'a', 'b', '$'};
+        for (int q = 0; q <= n; q++) ndfsm.addState();
+        ndfsm.addDefaultTransition(0, 0);
+        ndfsm.addTransition(0, 0, 1);
+        for (int q = 1; q < n; q++) ndfsm.addDefaultTransition(q, q + 1);
+        ndfsm.acceptingStates.insert(n);
+        ndfsm.finish();
+        DFSM dfsm = NDFSMtoDFSM::convertToDFSM(ndfsm);
+        check.expect(dfsm.numStates == 1 << n, "a as the symbol " + std::to_string(n) + " from the end has " +
+                     std::to_string(dfsm.numStates) + " DFSM states");
+    }
+
+    return check.finish();
+}
@@ -0,0 +1,44 @@
+// TestCheck.h
+#ifndef TESTCHECK_H
+#define TESTCHECK_H
+
+#include <iostream>
+#include <string>
+#include <random>
+
+// Counts the checks of a test program and prints the failed ones. finish()
+// prints the totals and gives the exit status, 1 if any check failed.
+class TestCheck {
+public:
+    explicit TestCheck(const std::string& name) : name(name) {}
+
+    bool expect(bool passed, const std::string& what) {
+        checks++;
+        if (!passed) {
+            failures++;
+            if (failures <= maxReported) std::cerr << "FAILED: " << what << std::endl;
+        }
+        return passed;
+    }
+
+    int finish() const {
+        std::cout << name << ": " << checks << " checks, " << failures << " failed" << std::endl;
+        return failures ? 1 : 0;
+    }
+
+    // Random string of 'length' characters from 'pool'
+    static std::string randomText(std::mt19937& random, const std::string& pool, size_t length) {
+        std::string text(length, ' ');
+        for (char& c : text) c = pool[random() % pool.size()];
+        return text;
+    }
+
+private:
+    static const int maxReported = 20;
+
+    std::string name;
+    int checks = 0;
+    int failures = 0;
+};
+
+#endif
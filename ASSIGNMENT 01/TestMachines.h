@@ -0,0 +1,116 @@
+// TestMachines.h
+#ifndef TESTMACHINES_H
+#define TESTMACHINES_H
+
+#include <vector>
+#include <string>
+#include <random>
+
+#include "NDFSM.h"
+#include "DFSM.h"
+
+// Random machines and direct simulations for the test programs. Symbols
+// are 'a', 'b', ... in alphabet order.
+namespace TestMachines {
+    // NDFSM with 'states' states over 'symbols' symbols. Each state gets a
+    // default cell with probability 'defaults'; each cell holds each target
+    // with probability 'density', and epsilon moves appear with
+    // probability 'epsilon'.
+    inline NDFSM randomNDFSM(std::mt19937& random, int states, int symbols, double density, double epsilon,
+                             double defaults = 0.3) {
+        std::uniform_real_distribution<double> chance(0, 1);
+        NDFSM ndfsm;
+        for (int s = 0; s < symbols; s++) ndfsm.alphabet.push_back('a' + s);
+        ndfsm.alphabet.push_back('$');
+        for (int q = 0; q < states; q++) ndfsm.addState();
+        for (int q = 0; q < states; q++) {
+            if (chance(random) < defaults) ndfsm.addDefaultTransition(q, random() % states);
+            for (int s = 0; s < symbols; s++) {
+                for (int t = 0; t < states; t++) {
+                    if (chance(random) < density) ndfsm.addTransition(q, s, t);
+                }
+            }
+            for (int t = 0; t < states; t++) {
+                if (t != q && chance(random) < epsilon) ndfsm.addTransition(q, ndfsm.epsilonIndex(), t);
+            }
+            if (chance(random) < 0.3) ndfsm.acceptingStates.insert(q);
+        }
+        ndfsm.finish();
+        return ndfsm;
+    }
+
+    inline DFSM randomDFSM(std::mt19937& random, int states, int symbols, double accepting = 0.4) {
+        std::uniform_real_distribution<double> chance(0, 1);
+        DFSM dfsm;
+        for (int s = 0; s < symbols; s++) dfsm.alphabet.push_back('a' + s);
+        for (int q = 0; q < states; q++) dfsm.addState();
+        for (int q = 0; q < states; q++) {
+            for (int s = 0; s < symbols; s++) dfsm.transitions[(size_t) q * symbols + s] = random() % states;
+            dfsm.accepting[q] = chance(random) < accepting;
+        }
+        return dfsm;
+    }
+
+    // Every string over the first 'symbols' letters of length at most 'length'
+    inline std::vector<std::string> allStrings(int symbols, int length) {
+        std::vector<std::string> strings(1, "");
+        for (size_t i = 0; i < strings.size(); i++) {
+            if ((int) strings[i].size() == length) continue;
+            for (int s = 0; s < symbols; s++) strings.push_back(strings[i] + (char) ('a' + s));
+        }
+        return strings;
+    }
+
+    // Set simulation straight from the transition cells
+    inline bool accepts(const NDFSM& ndfsm, const std::string& text) {
+        int n = ndfsm.numStates();
+        std::vector<char> current(n, 0), next(n, 0);
+        auto close = [&](std::vector<char>& set) {
+            std::vector<int> stack;
+            for (int q = 0; q < n; q++) {
+                if (set[q]) stack.push_back(q);
+            }
+            while (!stack.empty()) {
+                int q = stack.back();
+                stack.pop_back();
+                for (int t : ndfsm.epsilonTargets(q)) {
+                    if (!set[t]) {
+                        set[t] = 1;
+                        stack.push_back(t);
+                    }
+                }
+            }
+        };
+        current[0] = 1;
+        close(current);
+        for (char c : text) {
+            int symbol = ndfsm.symbolIndex(c);
+            if (symbol < 0) return false;
+            std::fill(next.begin(), next.end(), 0);
+            for (int q = 0; q < n; q++) {
+                if (!current[q]) continue;
+                for (int t : ndfsm.targets(q, symbol)) next[t] = 1;
+            }
+            close(next);
+            current.swap(next);
+        }
+        for (int q : ndfsm.acceptingStates) {
+            if (current[q]) return true;
+        }
+        return false;
+    }
+
+    // False for strings with symbols outside the alphabet
+    inline bool accepts(const DFSM& dfsm, const std::string& text) {
+        std::vector<int> symbolMap = dfsm.symbolMap();
+        int state = 0;
+        for (char c : text) {
+            int symbol = symbolMap[(unsigned char) c];
+            if (symbol < 0) return false;
+            state = dfsm.next(state, symbol);
+        }
+        return dfsm.accepting[state];
+    }
+}
+
+#endif
@@ -0,0 +1,96 @@
+// WildcardMatch Program
+// Tests whether an input string contains a wildcard pattern such as
+// "ab?d[0-9]x": '?' matches any symbol, [...] a class of symbols with ranges
+// and [^...] for the complement, and '\' makes the next character literal.
+// The pattern runs on the Shift-Or engine with its masks built from the
+// pattern, without determinizing; --determinize goes through the NDFSM and a
+// minimal DFSM instead. --ndfsm also writes the pattern's NDFSM to a file.
+//
+// The alphabet is every character the pattern mentions plus those given with
+// -a, which also decides what '?' and [^...] can match. As in the
+// simulators, spaces and newlines are skipped and any other character
+// outside the alphabet is an error.
+//
+// HOW TO RUN THE CODE:
+// >>g++ -std=c++17 -O2 -o WildcardMatch WildcardMatch.cpp
+// >>./WildcardMatch [-a <alphabet>] [--determinize] [--ndfsm NFSM.txt] [--stats] "ab?d[0-9]x" INPUT.txt
+
+#include <iostream>
+#include <string>
+
+#include "NDFSMBuilder.h"
+#include "NDFSMtoDFSM.h"
+#include "ShiftOrMatcher.h"
+#include "DFSMEngine.h"
+#include "MappedFile.h"
+#include "Stats.h"
+
+int main(int argc, char* argv[]) {
+    bool wantStats = Stats::takeFlag(argc, argv);
+    Stats stats("WildcardMatch");
+    Stats* statsOut = wantStats ? &stats : nullptr;
+    std::string alphabet, ndfsmFile;
+    bool determinize = false;
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; arg++) {
+        std::string option = argv[arg];
+        if (option == "-a" && arg + 1 < argc) {
+            alphabet = argv[++arg];
+        } else if (option == "--determinize") {
+            determinize = true;
+        } else if (option == "--ndfsm" && arg + 1 < argc) {
+            ndfsmFile = argv[++arg];
+        } else {
+            arg = argc;
+        }
+    }
+    if (argc - arg != 2) {
+        std::cerr << "Usage: " << argv[0] << " [-a <alphabet>] [--determinize] [--ndfsm <NDFSM file>] [--stats] <pattern> <input string file>" << std::endl;
+        return 1;
+    }
+
+    std::string pattern = argv[arg];
+    try {
+        std::vector<char> symbols;
+        std::vector<std::set<char>> classes = NDFSMBuilder::parseWildcards(pattern, alphabet, symbols);
+        stats.set("positions", classes.size());
+        NDFSM ndfsm;
+        if (determinize || !ndfsmFile.empty()) {
+            Stats::Stage build(statsOut, "build_ndfsm");
+            ndfsm = NDFSMBuilder::buildWildcard(pattern, alphabet);
+            build.stop();
+            stats.set("nfa_states", ndfsm.numStates());
+        }
+        if (!ndfsmFile.empty()) {
+            ndfsm.writeToFile(ndfsmFile);
+            std::cout << "NDFSM specification written to " << ndfsmFile << std::endl;
+        }
+
+        MappedFile input(argv[arg + 1]);
+        bool accepted;
+        if (determinize) {
+            DFSM dfsm = NDFSMtoDFSM::convertToDFSM(ndfsm, 1, true, statsOut);
+            stats.set("dfa_states", dfsm.numStates);
+            Stats::Stage simulate(statsOut, "simulate");
+            simulate.addBytes(input.size());
+            int current = withDFSMEngine(dfsm, InputPolicy(), smallPages, true, [&](const auto& engine) {
+                return engine.run(input.data(), input.size());
+            });
+            accepted = dfsm.accepting[current];
+        } else {
+            Stats::Stage build(statsOut, "build_masks");
+            ShiftOrMatcher matcher(classes, symbols);
+            build.stop();
+            stats.set("mask_words", matcher.numWords());
+            Stats::Stage simulate(statsOut, "simulate");
+            simulate.addBytes(input.size());
+            accepted = matcher.accepts(input.data(), input.size());
+        }
+        std::cout << (accepted ? "yes" : "no") << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    if (wantStats) stats.report();
+    return 0;
+}
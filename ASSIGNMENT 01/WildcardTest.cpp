@@ -0,0 +1,204 @@
+// WildcardTest Program
+// Checks wildcard patterns (NDFSMBuilder::parseWildcards) and the Shift-Or
+// engine: random patterns of 1 to 130 positions with '?', classes, ranges,
+// negated classes and escapes are parsed into the classes they were built
+// from, and ShiftOrMatcher and the determinized substring machine agree with
+// a direct search on random inputs, with blanks and unknown characters.
+// Malformed patterns must be rejected.
+//
+// HOW TO RUN THE CODE:
+// >>g++ -std=c++17 -O2 -o WildcardTest WildcardTest.cpp
+// >>./WildcardTest
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <set>
+
+#include "NDFSMBuilder.h"
+#include "NDFSMtoDFSM.h"
+#include "ShiftOrMatcher.h"
+#include "DFSMEngine.h"
+#include "TestCheck.h"
+
+// A pattern position as written, before '?' and [^...] meet the alphabet
+struct Position {
+    std::string text;
+    std::set<char> listed;
+    bool any = false;
+    bool negated = false;
+};
+
+static const std::string extraSymbols = "abcdef";
+
+static char randomChar(std::mt19937& random, const std::string& pool) {
+    return pool[random() % pool.size()];
+}
+
+static Position randomPosition(std::mt19937& random) {
+    Position position;
+    int kind = random() % 10;
+    if (kind < 4) {
+        char c = randomChar(random, "abcdef-^");
+        position.text = c;
+        position.listed.insert(c);
+    } else if (kind < 5) {
+        char c = randomChar(random, "?\\-");
+        position.text = std::string("\\") + c;
+        position.listed.insert(c);
+    } else if (kind < 7) {
+        position.text = "?";
+        position.any = true;
+    } else {
+        position.negated = kind == 9;
+        position.text = position.negated ? "[^" : "[";
+        for (int items = 1 + random() % 3; items > 0; items--) {
+            if (random() % 6 == 0) {
+                position.text += "\\-";
+                position.listed.insert('-');
+                continue;
+            }
+            char low = randomChar(random, "abcdefgh");
+            position.text += low;
+            position.listed.insert(low);
+            if (random() % 2) {
+                char high = low + random() % ('h' - low + 1);
+                position.text += std::string("-") + high;
+                for (char c = low; c <= high; c++) position.listed.insert(c);
+            }
+        }
+        position.text += "]";
+    }
+    return position;
+}
+
+// Classes the positions stand for, or empty when one of them matches nothing
+static std::vector<std::set<char>> resolve(const std::vector<Position>& positions, std::vector<char>& alphabet) {
+    std::set<char> symbols(extraSymbols.begin(), extraSymbols.end());
+    for (const Position& position : positions) symbols.insert(position.listed.begin(), position.listed.end());
+    alphabet.assign(symbols.begin(), symbols.end());
+
+    std::vector<std::set<char>> classes;
+    for (const Position& position : positions) {
+        std::set<char> members;
+        for (char c : alphabet) {
+            if (position.any || position.listed.count(c) != (size_t) position.negated) members.insert(c);
+        }
+        if (members.empty()) return std::vector<std::set<char>>();
+        classes.push_back(members);
+    }
+    return classes;
+}
+
+// Substring search over the input with blanks removed
+static bool contains(const std::vector<std::set<char>>& classes, const std::string& text) {
+    std::string symbols;
+    for (char c : text) {
+        if (c != ' ' && c != '\n') symbols += c;
+    }
+    for (size_t start = 0; start + classes.size() <= symbols.size(); start++) {
+        size_t i = 0;
+        while (i < classes.size() && classes[i].count(symbols[start + i])) i++;
+        if (i == classes.size()) return true;
+    }
+    return false;
+}
+
+// 1 accepted, 0 rejected, -1 an error
+template <typename Run>
+static int outcome(Run run) {
+    try {
+        return run() ? 1 : 0;
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+static bool rejected(const std::string& pattern) {
+    std::vector<char> alphabet;
+    return outcome([&]() { return !NDFSMBuilder::parseWildcards(pattern, "", alphabet).empty(); }) < 0;
+}
+
+int main() {
+    TestCheck check("WildcardTest");
+    std::mt19937 random(50);
+    const std::vector<int> lengths = {1, 2, 7, 63, 64, 65, 100, 127, 128, 129, 130};
+
+    for (int round = 0; round < 400; round++) {
+        int length = round < (int) lengths.size() ? lengths[round] : 1 + random() % 130;
+        std::vector<Position> positions;
+        std::string pattern;
+        for (int i = 0; i < length; i++) {
+            positions.push_back(randomPosition(random));
+            pattern += positions.back().text;
+        }
+        std::string name = "pattern " + pattern;
+
+        std::vector<char> expectedAlphabet, alphabet;
+        std::vector<std::set<char>> expected = resolve(positions, expectedAlphabet);
+        std::vector<std::set<char>> classes;
+        int parsed = outcome([&]() {
+            classes = NDFSMBuilder::parseWildcards(pattern, extraSymbols, alphabet);
+            return true;
+        });
+        if (expected.empty()) {
+            check.expect(parsed < 0, name + ": class without symbols is rejected");
+            continue;
+        }
+        if (!check.expect(parsed > 0 && classes == expected && alphabet == expectedAlphabet, name + ": classes")) continue;
+
+        ShiftOrMatcher matcher(classes, alphabet);
+        check.expect(matcher.numWords() == (size_t) (length + 63) / 64, name + ": mask words");
+
+        // Machines with wildcards near the front blow up when determinized
+        DFSM dfsm;
+        bool determinize = length <= 12;
+        if (determinize) dfsm = NDFSMtoDFSM::convertToDFSM(NDFSMBuilder::buildWildcard(pattern, extraSymbols), 1, true);
+
+        std::string pool(alphabet.begin(), alphabet.end());
+        pool += " \n";
+        for (int input = 0; input < 10; input++) {
+            std::string text = TestCheck::randomText(random, pool, random() % (input < 5 ? 300 : 9000));
+
+            // Plant an occurrence, sometimes with one symbol changed, often across a 4 KB chunk
+            if (random() % 2) {
+                std::string occurrence;
+                for (const std::set<char>& members : classes) {
+                    occurrence += *std::next(members.begin(), random() % members.size());
+                }
+                if (random() % 3 == 0) occurrence[random() % occurrence.size()] = randomChar(random, pool);
+                size_t at = text.size() > 4096 && random() % 2 ? 4096 - random() % occurrence.size() : random() % (text.size() + 1);
+                text.insert(std::min(at, text.size()), occurrence);
+            }
+            if (random() % 8 == 0) text.insert(random() % (text.size() + 1), 1, randomChar(random, "xyz"));
+
+            bool unknown = text.find_first_of("xyz") != std::string::npos;
+            int reference = unknown ? -1 : contains(classes, text);
+            std::string what = name + ", input " + std::to_string(input);
+            check.expect(outcome([&]() { return matcher.accepts(text.data(), text.size()); }) == reference, what + ": Shift-Or");
+            if (determinize) {
+                int determinized = outcome([&]() {
+                    int state = withDFSMEngine(dfsm, InputPolicy(), smallPages, true, [&](const auto& engine) {
+                        return engine.run(text.data(), text.size());
+                    });
+                    return (bool) dfsm.accepting[state];
+                });
+                check.expect(determinized == reference, what + ": determinized");
+            }
+        }
+    }
+
+    check.expect(rejected(""), "empty pattern");
+    check.expect(rejected("a[d-a]"), "range running backwards");
+    check.expect(rejected("a[bc"), "unterminated class");
+    check.expect(rejected("a[^"), "unterminated negated class");
+    check.expect(rejected("[]"), "empty class");
+    check.expect(rejected("ab\\"), "trailing backslash");
+    check.expect(rejected("a$b"), "reserved symbol");
+    check.expect(rejected("a[^a]"), "negated class covering the alphabet");
+    check.expect(rejected("???"), "wildcards without an alphabet");
+    check.expect(rejected("a\\[b"), "escaped '[', which is reserved");
+    check.expect(!rejected("[a-a]\\?\\\\"), "escaped '?' and '\\'");
+
+    return check.finish();
+}